@@ -15,7 +15,6 @@ lessThan(QT_MAJOR_VERSION, 6):lessThan(QT_MINOR_VERSION, 14) {
 
 !android {
     SUBDIRS += QuasarAppLib \
-               Pe \
                Deploy \
                CQtDeployer \
                UnitTests \
@@ -37,7 +36,6 @@ lessThan(QT_MAJOR_VERSION, 6):lessThan(QT_MINOR_VERSION, 14) {
     CQtDeployer.depends=Deploy
 
     QuasarAppLib.file = $$PWD/QuasarAppLib/QuasarApp.pro
-    Pe.file = $$PWD/pe/pe-parser-library/pe-parser-library.pro
 
     include('$$PWD/QIFData/installerCQtDeployer.pri')
     include($$PWD/doc/wiki.pri)
@@ -12,9 +12,50 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QList>
+#include <batchdeploy.h>
 #include <deploy.h>
+#include <deployserver.h>
 #include <QTimer>
 
+/**
+ * @brief serverName - return name of the local socket for the server and client modes.
+ */
+static QString serverName(const QString& key) {
+    auto name = QuasarAppUtils::Params::getStrArg(key);
+    if (name.isEmpty()) {
+        return DEFAULT_SERVER_NAME;
+    }
+
+    return name;
+}
+
+/**
+ * @brief clientArgs - return arguments of the deploy request without the connect option.
+ * Also used for the batch deploy.
+ */
+static QStringList clientArgs(int argc, char *argv[]) {
+    QStringList args;
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = argv[i];
+
+        if (arg == "-connect") {
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                ++i;
+            }
+            continue;
+        }
+
+        if (arg == "connect") {
+            continue;
+        }
+
+        args.push_back(arg);
+    }
+
+    return args;
+}
+
 
 int main(int argc, char *argv[]) {
 
@@ -29,6 +70,42 @@ int main(int argc, char *argv[]) {
         exit(0);
     }
 
+    if (QuasarAppUtils::Params::isEndable("connect")) {
+        return DeployServer::submit(serverName("connect"), clientArgs(argc, argv));
+    }
+
+    if (QuasarAppUtils::Params::isEndable("server")) {
+        QCoreApplication app(argc, argv);
+        DeployServer server;
+
+        if (!server.listen(serverName("server"))) {
+            return PrepareError;
+        }
+
+        return app.exec();
+    }
+
+    if (BatchDeploy::isBatch()) {
+        BatchDeploy batch;
+        return batch.run(clientArgs(argc, argv));
+    }
+
+    if (QuasarAppUtils::Params::isEndable("watch")) {
+        QCoreApplication app(argc, argv);
+        Deploy deploy;
+
+        int code = deploy.run();
+        if (code != Good) {
+            return code;
+        }
+
+        if (!deploy.watch()) {
+            return DeployError;
+        }
+
+        return app.exec();
+    }
+
     Deploy deploy;
     return deploy.run();
 }
@@ -13,6 +13,7 @@
 #-------------------------------------------------
 
 QT       -= gui
+QT       += network concurrent
 CONFIG += c++17
 TARGET = Deploy
 TEMPLATE = lib
@@ -41,10 +42,11 @@ CONFIG(release, debug|release): {
 }
 
 include('$$PWD/../QuasarAppLib/QuasarLib.pri')
-include('$$PWD/../pe/pe-parser-library/pe-parser-library.pri')
 
 
 SOURCES += \
+    batchdeploy.cpp \
+    binarysniffer.cpp \
     Distributions/defaultdistro.cpp \
     Distributions/templateinfo.cpp \
     dependencymap.cpp \
@@ -54,12 +56,18 @@ SOURCES += \
     configparser.cpp \
     deploy.cpp \
     deploycore.cpp \
+    deploymanifest.cpp \
+    deployserver.cpp \
+    dirwalker.cpp \
+    deploywatcher.cpp \
     envirement.cpp \
     extra.cpp \
     extracter.cpp \
     filemanager.cpp \
+    fingerprint.cpp \
     Distributions/idistribution.cpp \
     ignorerule.cpp \
+    ldsocache.cpp \
     metafilemanager.cpp \
     packing.cpp \
     pathutils.cpp \
@@ -73,9 +81,13 @@ SOURCES += \
     qml.cpp \
     libinfo.cpp \
     qtdir.cpp \
-    targetinfo.cpp
+    statcache.cpp \
+    targetinfo.cpp \
+    verifier.cpp
 
 HEADERS += \
+    batchdeploy.h \
+    binarysniffer.h \
     Distributions/defaultdistro.h \
     Distributions/templateinfo.h \
     dependencymap.h \
@@ -86,12 +98,18 @@ HEADERS += \
     deploy.h \
     deploy_global.h \
     deploycore.h \
+    deploymanifest.h \
+    deployserver.h \
+    dirwalker.h \
+    deploywatcher.h \
     envirement.h \
     extra.h \
     extracter.h \
     filemanager.h \
+    fingerprint.h \
     Distributions/idistribution.h \
     ignorerule.h \
+    ldsocache.h \
     metafilemanager.h \
     packing.h \
     pathutils.h \
@@ -105,7 +123,9 @@ HEADERS += \
     qml.h \
     libinfo.h \
     qtdir.h \
-    targetinfo.h
+    statcache.h \
+    targetinfo.h \
+    verifier.h
 
 STATECHARTS +=
 
@@ -0,0 +1,86 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "batchdeploy.h"
+#include "deploy.h"
+#include "deploycore.h"
+#include "dependenciesscanner.h"
+
+#include <quasarapp.h>
+
+BatchDeploy::BatchDeploy(DependenciesScanner *scaner) {
+    _scaner = scaner;
+
+    if (!_scaner) {
+        _scaner = new DependenciesScanner();
+        _ownScaner = true;
+    }
+}
+
+BatchDeploy::~BatchDeploy() {
+    if (_ownScaner) {
+        delete _scaner;
+    }
+}
+
+bool BatchDeploy::isBatch() {
+    return QuasarAppUtils::Params::getStrArg("confFile").
+            split(DeployCore::getSeparator(0), QString::SkipEmptyParts).size() > 1;
+}
+
+int BatchDeploy::run(const QStringList &args) {
+    auto confFiles = QuasarAppUtils::Params::getStrArg("confFile").
+            split(DeployCore::getSeparator(0), QString::SkipEmptyParts);
+
+    auto appPath = QuasarAppUtils::Params::getStrArg("appPath");
+    int result = Good;
+
+    for (const auto &confFile : confFiles) {
+        QuasarAppUtils::Params::log("Batch deploy of " + confFile,
+                                    QuasarAppUtils::Info);
+
+        if (!QuasarAppUtils::Params::parseParams(argsForConfFile(args, confFile))) {
+            QuasarAppUtils::Params::log("wrong parametrs for " + confFile,
+                                        QuasarAppUtils::Error);
+            result = (result == Good)? PrepareError: result;
+            continue;
+        }
+
+        if (QuasarAppUtils::Params::getStrArg("appPath").isEmpty()) {
+            QuasarAppUtils::Params::setArg("appPath", appPath);
+        }
+
+        Deploy deploy(_scaner);
+        deploy.setAllowedTargetDirs(_allowedTargetDirs);
+        int code = deploy.run();
+
+        if (code != Good) {
+            QuasarAppUtils::Params::log("Deploy of " + confFile + " is failed with code " +
+                                        QString::number(code),
+                                        QuasarAppUtils::Error);
+            result = (result == Good)? code: result;
+        }
+    }
+
+    return result;
+}
+
+void BatchDeploy::setAllowedTargetDirs(const QStringList &dirs) {
+    _allowedTargetDirs = dirs;
+}
+
+QStringList BatchDeploy::argsForConfFile(const QStringList &args,
+                                         const QString &confFile) const {
+    QStringList result = args;
+
+    int index = result.indexOf("-confFile");
+    if (index >= 0 && index + 1 < result.size()) {
+        result[index + 1] = confFile;
+    }
+
+    return result;
+}
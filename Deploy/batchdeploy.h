@@ -0,0 +1,59 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef BATCHDEPLOY_H
+#define BATCHDEPLOY_H
+
+#include <QStringList>
+#include "deploy_global.h"
+
+class DependenciesScanner;
+
+/**
+ * @brief The BatchDeploy class - runs deploys of many configuration files in one process.
+ * All deploys of the batch use the one dependencies scaner,
+ * so the scaned libraries, the envirement index and the qmake query results are shared between them.
+ * The scaned libraries are reused only by the configurations with the same scaner options
+ * (envirement, ignore list, deploySystem, qt dir, extraLibs), see DependenciesScanner::setEnvironment.
+ */
+class DEPLOYSHARED_EXPORT BatchDeploy
+{
+public:
+    /**
+     * @brief BatchDeploy
+     * @param scaner - shared scaner. If scaner is nullptr then batch create own scaner.
+     */
+    explicit BatchDeploy(DependenciesScanner *scaner = nullptr);
+    ~BatchDeploy();
+
+    /**
+     * @brief isBatch
+     * @return true if the confFile option contains more than one configuration file.
+     */
+    static bool isBatch();
+
+    /**
+     * @brief run - deploy all configuration files from the confFile option.
+     * @param args - arguments of the cqtdeployer. The confFile value will be replaced for each deploy.
+     * @return the first not good exit code or Good if all deploys finished successful.
+     */
+    int run(const QStringList& args);
+
+    /**
+     * @brief setAllowedTargetDirs - restrict the target dirs of all deploys of the batch (see Deploy::setAllowedTargetDirs).
+     */
+    void setAllowedTargetDirs(const QStringList& dirs);
+
+private:
+    DependenciesScanner *_scaner = nullptr;
+    bool _ownScaner = false;
+    QStringList _allowedTargetDirs;
+
+    QStringList argsForConfFile(const QStringList& args, const QString& confFile) const;
+};
+
+#endif // BATCHDEPLOY_H
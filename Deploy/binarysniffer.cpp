@@ -0,0 +1,196 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "binarysniffer.h"
+#include "statcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtEndian>
+
+#define SNIFF_PAGE_SIZE 4096
+
+#define ELF_ET_EXEC 2
+#define ELF_ET_DYN 3
+#define ELF_PT_INTERP 3
+
+#define PE_DLL_FLAG 0x2000
+#define PE_MAGIC_32 0x10B
+#define PE_MAGIC_64 0x20B
+
+QHash<QString, BinarySniffer::CacheItem> BinarySniffer::_cache;
+QMutex BinarySniffer::_mutex;
+
+bool BinaryInfo::isBinary() const {
+    return format != NotBinary;
+}
+
+bool BinaryInfo::isExecutable() const {
+    return isBinary() && !isLib;
+}
+
+template <typename T>
+static bool readValue(const QByteArray& page, qint64 offset, bool littleEndian, T& value) {
+    if (offset < 0 || offset + static_cast<qint64>(sizeof(T)) > page.size()) {
+        return false;
+    }
+
+    auto data = page.constData() + offset;
+    value = (littleEndian)? qFromLittleEndian<T>(data): qFromBigEndian<T>(data);
+    return true;
+}
+
+BinaryInfo BinarySniffer::sniffElf(const QByteArray &page, const QString &fileName) {
+    BinaryInfo result;
+
+    // e_ident: magic (4) class (1) data (1)
+    if (page.size() < 0x34) {
+        return result;
+    }
+
+    bool is64 = page[4] == 2;
+    bool littleEndian = page[5] == 1;
+
+    if (page[4] != 1 && !is64) {
+        return result;
+    }
+
+    quint16 type = 0;
+    readValue(page, 16, littleEndian, type);
+
+    if (type != ELF_ET_EXEC && type != ELF_ET_DYN) {
+        return result;
+    }
+
+    result.format = BinaryInfo::ELF;
+    result.platform = (is64)? Unix64 : Unix32;
+
+    if (type == ELF_ET_EXEC) {
+        return result;
+    }
+
+    // ET_DYN is the library or the position independent executable, the executables have the interpreter.
+    quint64 phOffset = 0;
+    quint16 phSize = 0;
+    quint16 phCount = 0;
+
+    if (is64) {
+        readValue(page, 32, littleEndian, phOffset);
+        readValue(page, 54, littleEndian, phSize);
+        readValue(page, 56, littleEndian, phCount);
+    } else {
+        quint32 phOffset32 = 0;
+        readValue(page, 28, littleEndian, phOffset32);
+        readValue(page, 42, littleEndian, phSize);
+        readValue(page, 44, littleEndian, phCount);
+        phOffset = phOffset32;
+    }
+
+    bool interp = false;
+    for (quint16 i = 0; i < phCount; ++i) {
+        quint32 phType = 0;
+        if (!readValue(page, static_cast<qint64>(phOffset + static_cast<quint64>(i) * phSize),
+                       littleEndian, phType)) {
+            break;
+        }
+
+        if (phType == ELF_PT_INTERP) {
+            interp = true;
+            break;
+        }
+    }
+
+    // some libraries (libc) can be executed too.
+    result.isLib = !interp || fileName.contains(".so", Qt::CaseInsensitive);
+
+    return result;
+}
+
+BinaryInfo BinarySniffer::sniffPe(const QByteArray &page) {
+    BinaryInfo result;
+
+    quint32 peOffset = 0;
+    if (!readValue(page, 0x3c, true, peOffset)) {
+        return result;
+    }
+
+    quint32 signature = 0;
+    quint16 characteristics = 0;
+    quint16 magic = 0;
+
+    if (!readValue(page, peOffset, true, signature) || signature != 0x00004550 ||
+            !readValue(page, peOffset + 22, true, characteristics) ||
+            !readValue(page, peOffset + 24, true, magic)) {
+        return result;
+    }
+
+    if (magic == PE_MAGIC_32) {
+        result.platform = Win32;
+    } else if (magic == PE_MAGIC_64) {
+        result.platform = Win64;
+    } else {
+        return result;
+    }
+
+    result.format = BinaryInfo::PE;
+    result.isLib = characteristics & PE_DLL_FLAG;
+
+    return result;
+}
+
+BinaryInfo BinarySniffer::sniffData(const QByteArray &page, const QString &fileName) {
+    if (page.startsWith("\x7f" "ELF")) {
+        return sniffElf(page, fileName);
+    }
+
+    if (page.startsWith("MZ")) {
+        return sniffPe(page);
+    }
+
+    return {};
+}
+
+BinaryInfo BinarySniffer::sniff(const QString &file) {
+    auto stat = StatCache::stat(file);
+
+    if (!stat.isFile) {
+        return {};
+    }
+
+    QFileInfo info(file);
+    auto path = info.absoluteFilePath();
+
+    {
+        QMutexLocker locker(&_mutex);
+        auto it = _cache.constFind(path);
+        if (it != _cache.constEnd() &&
+                it->size == stat.size && it->lastModified == stat.lastModified) {
+            return it->info;
+        }
+    }
+
+    CacheItem item;
+    item.size = stat.size;
+    item.lastModified = stat.lastModified;
+
+    QFile binary(path);
+    if (binary.open(QIODevice::ReadOnly)) {
+        item.info = sniffData(binary.read(SNIFF_PAGE_SIZE), info.fileName());
+        binary.close();
+    }
+
+    QMutexLocker locker(&_mutex);
+    _cache.insert(path, item);
+
+    return item.info;
+}
+
+void BinarySniffer::clearCache() {
+    QMutexLocker locker(&_mutex);
+    _cache.clear();
+}
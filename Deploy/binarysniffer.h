@@ -0,0 +1,76 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef BINARYSNIFFER_H
+#define BINARYSNIFFER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include "deploycore.h"
+
+/**
+ * @brief The BinaryInfo struct - type of the file detected by the content of the file.
+ */
+struct DEPLOYSHARED_EXPORT BinaryInfo {
+    enum Format : quint8 {
+        NotBinary,
+        ELF,
+        PE
+    };
+
+    Format format = NotBinary;
+    Platform platform = UnknownPlatform;
+
+    /**
+     * @brief isLib - true for the shared libraries (ET_DYN without the interpreter, PE with the dll flag).
+     */
+    bool isLib = false;
+
+    bool isBinary() const;
+    bool isExecutable() const;
+};
+
+/**
+ * @brief The BinarySniffer class - detect the type of the file by the magic numbers of the header.
+ * Reads at most one page of the file, the results are cached per path (thread safe).
+ */
+class DEPLOYSHARED_EXPORT BinarySniffer
+{
+public:
+    /**
+     * @brief sniff
+     * @param file - path to the file.
+     * @return type of the file. For not existing files and not binaries returns the NotBinary format.
+     */
+    static BinaryInfo sniff(const QString& file);
+
+    /**
+     * @brief sniffData - detect the type of the binary by the begin of the file.
+     * @param page - begin of the file (one page).
+     * @param fileName - name of the file, used for the elf files that are the library and the executable at the same time.
+     */
+    static BinaryInfo sniffData(const QByteArray& page, const QString& fileName = "");
+
+    static void clearCache();
+
+private:
+    struct CacheItem {
+        QDateTime lastModified;
+        qint64 size = 0;
+        BinaryInfo info;
+    };
+
+    static QHash<QString, CacheItem> _cache;
+    static QMutex _mutex;
+
+    static BinaryInfo sniffElf(const QByteArray& page, const QString& fileName);
+    static BinaryInfo sniffPe(const QByteArray& page);
+};
+
+#endif // BINARYSNIFFER_H
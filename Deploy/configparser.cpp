@@ -6,13 +6,19 @@
 //#
 
 #include "configparser.h"
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
 #include <QProcess>
+#include <QSettings>
+#include <QtConcurrent>
+#include "binarysniffer.h"
 #include "dependenciesscanner.h"
 #include "deploycore.h"
+#include "dirwalker.h"
 #include "filemanager.h"
+#include "ldsocache.h"
 #include "packing.h"
 #include "pathutils.h"
 #include "quasarapp.h"
@@ -32,6 +38,19 @@
 
 static QString defaultPackage = "";
 
+/**
+ * qmakeQueryCache - output of the 'qmake -query' command for already used qmake executables.
+ * key - absolute path to qmake, value - modification times of qmake and qt.conf and the query output.
+ * This cache is used when the one process runs many deploys (see the DeployServer class).
+ * The query outputs are saved into the settings too, so the next runs do not start the qmake.
+ */
+static QHash<QString, QPair<QString, QString>> qmakeQueryCache;
+
+/**
+ * QMAKE_TIMEOUT - timeout of the 'qmake -query' command (msec). The qmake can start slowly on the loaded machines.
+ */
+#define QMAKE_TIMEOUT 30000
+
 template<typename Container, typename Setter>
 bool parsePackagesPrivate(Container& mainContainer,
                           const QStringList &inputParamsList,
@@ -58,11 +77,8 @@ bool parsePackagesPrivate(Container& mainContainer,
     return true;
 }
 
-bool ConfigParser::parseParams() {
-
+bool ConfigParser::loadConfFile() {
     auto path = QuasarAppUtils::Params::getStrArg("confFile");
-    bool createFile = !QFile::exists(path) &&
-            QuasarAppUtils::Params::isEndable("confFile");
 
     if (path.isEmpty() &&
             QuasarAppUtils::Params::customParamasSize() <= 0) {
@@ -77,6 +93,19 @@ bool ConfigParser::parseParams() {
         }
     }
 
+    return true;
+}
+
+bool ConfigParser::parseParams() {
+
+    auto path = QuasarAppUtils::Params::getStrArg("confFile");
+    bool createFile = !QFile::exists(path) &&
+            QuasarAppUtils::Params::isEndable("confFile");
+
+    if (!loadConfFile()) {
+        return false;
+    }
+
     auto distro = getDistribution();
     _packing->setDistribution(distro);
 
@@ -115,6 +144,18 @@ bool ConfigParser::parseParams() {
         break;
     }
 
+    case RunMode::Verify: {
+        QuasarAppUtils::Params::log("Verify ...",
+                                           QuasarAppUtils::Info);
+
+        if (!parseVerifyMode()) {
+            QuasarAppUtils::Params::log("verify is failed!",
+                                               QuasarAppUtils::Error);
+            return false;
+        }
+        break;
+    }
+
     case RunMode::Deploy: {
         QuasarAppUtils::Params::log("Deploy ...",
                                            QuasarAppUtils::Info);
@@ -598,6 +639,21 @@ bool ConfigParser::parseClearMode() {
     return true;
 }
 
+bool ConfigParser::parseVerifyMode() {
+    setTargetDir("./" + DISTRO_DIR);
+    initIgnoreList();
+
+    if (!initDistroStruct()) {
+        return false;
+    }
+
+    if (_config.packages().isEmpty()) {
+        _config.packagesEdit().insert(defaultPackage, {});
+    }
+
+    return true;
+}
+
 QSet<QString> ConfigParser::getQtPathesFromTargets() {
     QSet<QString> res;
 
@@ -693,35 +749,40 @@ bool ConfigParser::setBinDir(const QString &dir, bool recursive) {
     }
     QuasarAppUtils::Params::log("setBinDir check path: " + dir,
                                  QuasarAppUtils::Debug);
-    QFileInfoList list;
 
+    struct Candidate {
+        QString path;
+        bool isBinary = false;
+        QHash<QString, TargetInfo> target;
+    };
+
+    QVector<Candidate> candidates;
+
+    int filters = DirWalker::Files;
     if (recursive) {
-        list = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-    } else {
-        list = d.entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+        filters |= DirWalker::FollowSymlinks | DirWalker::Parallel;
     }
 
-    bool result = false;
-    for (const auto &file : list) {
-
-        if (file.isDir()) {
-            result |= setBinDir(file.absoluteFilePath(), recursive);
-            continue;
-        }
+    for (const auto &file : DirWalker::paths(dir, filters, recursive? -1 : 0)) {
+        candidates.push_back({file, false, {}});
+    }
 
-        auto name = file.fileName();
-        auto sufix = file.completeSuffix();
+    // sniff and parse the candidates in parallel, each task writes only into own item.
+    QtConcurrent::blockingMap(candidates, [this](Candidate& candidate) {
+        candidate.isBinary = BinarySniffer::sniff(candidate.path).isBinary();
 
-        if (sufix.isEmpty() ||  name.contains(".dll", Qt::CaseInsensitive) ||
-              name.contains(".so", Qt::CaseInsensitive) || name.contains(".exe", Qt::CaseInsensitive)) {
+        if (candidate.isBinary) {
+            candidate.target = createTarget(candidate.path);
+        }
+    });
 
+    bool result = false;
+    for (const auto &candidate : candidates) {
+        if (candidate.isBinary) {
             result = true;
-
-            _config.targetsEdit().unite(createTarget(QDir::fromNativeSeparators(file.absoluteFilePath())));
-
+            _config.targetsEdit().unite(candidate.target);
         }
-
-       }
+    }
 
     return result;
 }
@@ -760,8 +821,14 @@ void ConfigParser::initIgnoreList()
 
     if (!QuasarAppUtils::Params::isEndable("deploySystem-with-libc")) {
 
-        envUnix.addEnv(Envirement::recursiveInvairement("/lib", 3));
-        envUnix.addEnv(Envirement::recursiveInvairement("/usr/lib", 3));
+        auto &ldCache = LdSoCache::system();
+
+        if (!ldCache.isEmpty()) {
+            envUnix.addEnv(ldCache.dirs());
+        } else {
+            envUnix.addEnv(Envirement::recursiveInvairement("/lib", 3));
+            envUnix.addEnv(Envirement::recursiveInvairement("/usr/lib", 3));
+        }
         ruleUnix.prority = SystemLib;
         ruleUnix.platform = Unix;
         ruleUnix.enfirement = envUnix;
@@ -953,19 +1020,14 @@ bool ConfigParser::setQmake(const QString &value) {
         return false;
     }
 
-    QProcess proc;
-    proc.setProgram(qmakeInfo.absoluteFilePath());
-    proc.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-    proc.setArguments({"-query"});
-
-    proc.start();
-    if (!proc.waitForFinished(1000)) {
-        QuasarAppUtils::Params::log("run qmake fail!");
+    QString qmakeData;
 
+    if (QuasarAppUtils::Params::isEndable("noRunQmake")) {
+        qmakeData = readQtConf(qmakeInfo.absoluteFilePath());
+    } else if (!queryQmake(qmakeInfo.absoluteFilePath(), qmakeData)) {
         return false;
     }
 
-    QString qmakeData = proc.readAll();
     auto list = qmakeData.split('\n');
 
     for (const auto &value : list) {
@@ -999,6 +1061,107 @@ bool ConfigParser::setQmake(const QString &value) {
     return true;
 }
 
+bool ConfigParser::queryQmake(const QString &qmake, QString &result) const {
+    auto qtConf = QFileInfo(QFileInfo(qmake).absolutePath() + "/qt.conf");
+    auto stamp = QString::number(QFileInfo(qmake).lastModified().toMSecsSinceEpoch()) + ":" +
+            QString::number(qtConf.exists()? qtConf.lastModified().toMSecsSinceEpoch() : 0);
+
+    auto cached = qmakeQueryCache.value(qmake);
+    if (cached.first == stamp) {
+        result = cached.second;
+        return true;
+    }
+
+    auto settings = QuasarAppUtils::Settings::get();
+    auto saved = settings->getValue("qmakeQuery:" + qmake, "").toStringList();
+
+    if (saved.size() == 2 && saved.first() == stamp) {
+        result = saved.last();
+        qmakeQueryCache.insert(qmake, {stamp, result});
+        return true;
+    }
+
+    QProcess proc;
+    proc.setProgram(qmake);
+    proc.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+    proc.setArguments({"-query"});
+
+    proc.start();
+    if (!proc.waitForFinished(QMAKE_TIMEOUT) || proc.exitCode() != 0) {
+        QuasarAppUtils::Params::log("run qmake fail! " + proc.errorString());
+
+        return false;
+    }
+
+    result = proc.readAll();
+    qmakeQueryCache.insert(qmake, {stamp, result});
+    settings->setValue("qmakeQuery:" + qmake, QStringList{stamp, result});
+
+    return true;
+}
+
+QString ConfigParser::readQtConf(const QString &qmake) const {
+    QFileInfo qmakeInfo(qmake);
+    auto binDir = qmakeInfo.absolutePath();
+
+    // the qmake reads the qt.conf from the dir of the qmake executable.
+    // without the qt.conf the qt installation is expected to be relocatable (prefix is the parent dir of the bin dir).
+    QSettings qtConf(binDir + "/qt.conf", QSettings::IniFormat);
+    qtConf.beginGroup("Paths");
+
+    auto prefix = qtConf.value("Prefix", "..").toString();
+    if (QDir::isRelativePath(prefix)) {
+        prefix = QDir::cleanPath(binDir + "/" + prefix);
+    }
+
+    auto path = [&qtConf, &prefix](const QString& key, const QString& defaultValue) {
+        auto value = qtConf.value(key, defaultValue).toString();
+        if (QDir::isRelativePath(value)) {
+            value = QDir::cleanPath(prefix + "/" + value);
+        }
+
+        return value;
+    };
+
+    bool isWin = qmakeInfo.fileName().endsWith(".exe", Qt::CaseInsensitive);
+
+    auto libs = path("Libraries", "lib");
+    auto bins = path("Binaries", "bin");
+
+    // the qt can be built for other platform (cross compilation), so check the format of the QtCore library.
+    QStringList coreLibs;
+    for (const auto &dir: {libs, bins}) {
+        for (const auto &core: QDir(dir).entryInfoList({"*Qt?Core.dll", "libQt?Core.so*"}, QDir::Files)) {
+            coreLibs.push_back(core.absoluteFilePath());
+        }
+    }
+
+    for (const auto &core : coreLibs) {
+        auto info = BinarySniffer::sniff(core);
+        if (info.isBinary()) {
+            isWin = info.platform & Platform::Win;
+            break;
+        }
+    }
+
+    QStringList result = {
+        "QT_INSTALL_PREFIX:" + prefix,
+        "QT_INSTALL_LIBS:" + libs,
+        "QT_INSTALL_LIBEXECS:" + path("LibraryExecutables", (isWin)? "bin" : "libexec"),
+        "QT_INSTALL_BINS:" + bins,
+        "QT_INSTALL_PLUGINS:" + path("Plugins", "plugins"),
+        "QT_INSTALL_QML:" + path("Qml2Imports", "qml"),
+        "QT_INSTALL_TRANSLATIONS:" + path("Translations", "translations"),
+        "QT_INSTALL_DATA:" + path("Data", "."),
+        QString("QMAKE_XSPEC:") + ((isWin)? "win32-g++" : "linux-g++")
+    };
+
+    QuasarAppUtils::Params::log("qt installation readed without qmake: " + result.join(", "),
+                                QuasarAppUtils::Info);
+
+    return result.join('\n');
+}
+
 bool ConfigParser::setQtDir(const QString &value) {
 
     QFileInfo info(value);
@@ -1150,8 +1313,15 @@ void ConfigParser::initEnvirement() {
     QStringList dirs;
 #ifdef Q_OS_LINUX
 
-    dirs.append(getDirsRecursive("/lib", 5));
-    dirs.append(getDirsRecursive("/usr/lib", 5));
+    auto &ldCache = LdSoCache::system();
+
+    // the cache of the loader contains all dirs of the system libraries, use the recursive search only if the cache is not available.
+    if (!ldCache.isEmpty()) {
+        dirs.append(ldCache.dirs());
+    } else {
+        dirs.append(getDirsRecursive("/lib", 5));
+        dirs.append(getDirsRecursive("/usr/lib", 5));
+    }
 #else
     auto winPath = findWindowsPath(path);
     dirs.append(getDirsRecursive(winPath + "/System32", 2));
@@ -1180,11 +1350,11 @@ QSet<QString> ConfigParser::getSetDirsRecursive(const QString &path, int maxDepc
         return res;
     }
 
-    auto list = dir.entryInfoList(QDir::Dirs| QDir::NoDotAndDotDot);
+    // the entries of the path have the depth 0 in the walker.
+    int walkDepth = (maxDepch < 0)? -1 : maxDepch - depch - 1;
 
-    for (const auto &subDir: list) {
-        res.insert(subDir.absoluteFilePath());
-        res.unite(getSetDirsRecursive(subDir.absoluteFilePath(), maxDepch, depch + 1));
+    for (const auto &subDir : DirWalker::paths(path, DirWalker::Dirs | DirWalker::FollowSymlinks, walkDepth)) {
+        res.insert(subDir);
     }
 
     return res;
@@ -1212,6 +1382,7 @@ bool ConfigParser::smartMoveTargets() {
 
         auto newTargetKey = targetPath + "/" + target.fileName();
         temp.unite(moveTarget(i.value(), newTargetKey));
+        _movedTargets.insert(newTargetKey, target.absoluteFilePath());
 
         _config.packagesEdit()[i.value().getPackage()].addTarget(newTargetKey);
 
@@ -1222,6 +1393,10 @@ bool ConfigParser::smartMoveTargets() {
     return result;
 }
 
+const QHash<QString, QString> &ConfigParser::movedTargets() const {
+    return _movedTargets;
+}
+
 ConfigParser::ConfigParser(FileManager *filemanager, DependenciesScanner* scaner, Packing *pac):
     _fileManager(filemanager),
     _scaner(scaner),
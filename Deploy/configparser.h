@@ -37,6 +37,11 @@ private:
 
     QHash<QString, QString> _Targetpackages;
 
+    /**
+     * @brief _movedTargets - key: deployed target path, value: source path of the target.
+     */
+    QHash<QString, QString> _movedTargets;
+
     bool createFromDeploy(const QString& file) const;
     bool loadFromFile(const QString& file);
     bool initDistroStruct();
@@ -46,12 +51,22 @@ private:
     bool parseInitMode();
 
     bool parseClearMode();
+    bool parseVerifyMode();
 
     QSet<QString> getQtPathesFromTargets();
 
     void setTargetDir(const QString &target = "");
     bool setTargets(const QStringList &value);
     bool setTargetsRecursive(const QString &dir);
+
+    /**
+     * @brief setBinDir - add all binaries of the dir to the targets.
+     * The candidates are checked and parsed in parallel. The targets are stored in the hash,
+     * so the found set does not depend on the order of the checks, but the targets have no order.
+     * @param dir - path to the dir.
+     * @param recursive - search in the subdirs.
+     * @return true if at least one target found.
+     */
     bool setBinDir(const QString &dir, bool recursive = false);
 
     void initIgnoreList();
@@ -65,6 +80,20 @@ private:
     bool setQmake(const QString &value);
     bool setQtDir(const QString &value);
 
+    /**
+     * @brief queryQmake - get the output of the 'qmake -query' command.
+     *  The output is cached in the memory and in the settings of the application,
+     *  key of the cache - path of the qmake, the modification times of the qmake and the qt.conf.
+     * @return false if the qmake is not started.
+     */
+    bool queryQmake(const QString &qmake, QString &result) const;
+
+    /**
+     * @brief readQtConf - create the output of the 'qmake -query' from the qt.conf and the layout of the qt installation
+     *  without running the qmake (noRunQmake option).
+     */
+    QString readQtConf(const QString &qmake) const;
+
     void setExtraPath(const QStringList &value);
     void setExtraNames(const QStringList &value);
 
@@ -93,9 +122,21 @@ private:
     bool isNeededQt() const;
 public:
     ConfigParser(FileManager *filemanager, DependenciesScanner *scaner, Packing* pac);
+
+    /**
+     * @brief loadConfFile - merge the parameters of the config file (confFile option or the default CQtDeployer.json) into the parameters of the application.
+     * @return false if the config file exists but can not be parsed.
+     */
+    bool loadConfFile();
     bool parseParams();
     bool smartMoveTargets();
 
+    /**
+     * @brief movedTargets
+     * @return map of the deployed targets to their source files (filled by smartMoveTargets).
+     */
+    const QHash<QString, QString>& movedTargets() const;
+
     const DeployConfig* config() const;
     friend class deploytest;
 
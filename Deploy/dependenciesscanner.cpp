@@ -5,54 +5,128 @@
  * of this license document, but changing it is not allowed.
  */
 
+#include "binarysniffer.h"
 #include "dependenciesscanner.h"
 #include "deploycore.h"
 #include "quasarapp.h"
 #include "configparser.h"
+#include <QCryptographicHash>
 #include <QList>
 #include <QDir>
 #include <QDebug>
+#include <algorithm>
 #include "pathutils.h"
+#include "statcache.h"
 
 DependenciesScanner::DependenciesScanner() {
 
 }
 
 void DependenciesScanner::clearScaned() {
+    QWriteLocker locker(&_memoLock);
     _scanedLibs.clear();
+    _symbols.clear();
+    _prunedLibs.clear();
+    _prunedNeeded.clear();
 }
 
-PrivateScaner DependenciesScanner::getScaner(const QString &lib) const {
+void DependenciesScanner::clearScaned(const QSet<QString> &libs) {
+    QWriteLocker locker(&_memoLock);
+
+    for (const auto &lib : libs) {
+        _symbols.remove(lib);
+        _prunedNeeded.remove(lib);
+    }
+
+    for (auto it = _scanedLibs.begin(); it != _scanedLibs.end();) {
+
+        bool outdated = libs.contains(it.key());
+
+        for (auto dep = it->allDep.cbegin(); !outdated && dep != it->allDep.cend(); ++dep) {
+            outdated = libs.contains(dep->fullPath());
+        }
 
-    QFileInfo info(lib);
+        if (outdated) {
+            it = _scanedLibs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QHash<QString, qint64> DependenciesScanner::prunedLibs() const {
+    QReadLocker locker(&_memoLock);
+    return _prunedLibs;
+}
+
+QHash<QString, QSet<QString>> DependenciesScanner::prunedNeeded() const {
+    QReadLocker locker(&_memoLock);
+    return _prunedNeeded;
+}
 
-    auto sufix = info.completeSuffix();
+LibInfo DependenciesScanner::getScaned(const QString &lib) const {
+    QReadLocker locker(&_memoLock);
+    return _scanedLibs.value(lib);
+}
 
-    if (sufix.compare("dll", Qt::CaseSensitive) == 0 ||
-            sufix.compare("exe", Qt::CaseSensitive) == 0) {
-        return PrivateScaner::PE;
-    } else if (sufix.isEmpty() || sufix.contains("so", Qt::CaseSensitive)) {
-        return PrivateScaner::ELF;
+void DependenciesScanner::clearOutdated() {
+    _memoLock.lockForRead();
+    const auto scaned = _scanedLibs.keys();
+    _memoLock.unlock();
+
+    for (const auto &lib : scaned) {
+        if (QFileInfo(lib).lastModified() > _lastValidation) {
+            QuasarAppUtils::Params::log("scaned libraries cache is outdated",
+                                        QuasarAppUtils::Info);
+            clearScaned();
+            break;
+        }
     }
 
-    return PrivateScaner::UNKNOWN;
+    _lastValidation = QDateTime::currentDateTime();
+}
+
+PrivateScaner DependenciesScanner::getScaner(const QString &lib) const {
+
+    switch (BinarySniffer::sniff(lib).format) {
+    case BinaryInfo::PE: return PrivateScaner::PE;
+    case BinaryInfo::ELF: return PrivateScaner::ELF;
+    default: return PrivateScaner::UNKNOWN;
+    }
 }
 
-QMultiMap<LibPriority, LibInfo> DependenciesScanner::getLibsFromEnvirement(
-        const QString &libName) const {
+bool DependenciesScanner::getLibFromEnvirement(const QString &libName,
+                                               Platform platform,
+                                               LibInfo &result) const {
 
-    auto values = _EnvLibs.values(libName.toUpper());
-    QMultiMap<LibPriority, LibInfo> res;
+    // the libraries are found in the order of the envirement, sort them by priority.
+    auto values = findInEnvirement(libName);
 
+    QList<QPair<LibPriority, QString>> candidates;
     for (const auto & lib : values) {
-        LibInfo info;
+        candidates.push_back({DeployCore::getLibPriority(lib), lib});
+    }
 
-        auto priority = (DeployCore::getLibPriority(lib));
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const QPair<LibPriority, QString>& left, const QPair<LibPriority, QString>& right) {
+        return left.first < right.first;
+    });
+
+    for (const auto & candidate : candidates) {
+        auto priority = candidate.first;
+        const auto &lib = candidate.second;
 
         if ((priority >= SystemLib) && !QuasarAppUtils::Params::isEndable("deploySystem")) {
             continue;
         }
 
+        // skip the libraries of other architecture before the full parse.
+        auto sniffed = BinarySniffer::sniff(lib).platform;
+        if (sniffed != UnknownPlatform && sniffed != platform) {
+            continue;
+        }
+
+        LibInfo info;
         if (!fillLibInfo(info, lib)) {
             QuasarAppUtils::Params::log(
                         "error extract lib info from " + lib + "(" + libName + ")",
@@ -60,15 +134,91 @@ QMultiMap<LibPriority, LibInfo> DependenciesScanner::getLibsFromEnvirement(
             continue;
         }
 
+        if (info.getPlatform() != platform) {
+            continue;
+        }
+
         info.setPriority(priority);
 
         if (!DeployCore::_config->ignoreList.isIgnore(info)) {
-            res.insertMulti(info.getPriority(), info);
+            result = info;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QStringList DependenciesScanner::findInEnvirement(const QString &libName) const {
+#ifdef Q_OS_WIN
+    // the names of the dlls are case insensitive.
+    auto key = libName.toUpper();
+#else
+    const auto &key = libName;
+#endif
+
+    {
+        QReadLocker locker(&_envLock);
+        auto it = _envLookup.constFind(key);
+        if (it != _envLookup.cend()) {
+            return it.value();
         }
+    }
+
+    QStringList result;
+
+#ifndef Q_OS_WIN
+    // the names of the dlls are case insensitive, but the file system is not.
+    if (libName.endsWith(".dll", Qt::CaseInsensitive)) {
+        auto name = libName.toUpper();
+
+        QWriteLocker locker(&_envLock);
+        for (const auto &dir : _envirement) {
+            auto &dlls = _envDlls[dir];
+
+            if (!dlls.listed) {
+                auto list = QDir(dir).entryInfoList({"*.dll", "*.DLL"}, QDir::Files | QDir::Hidden);
+                for (const auto &dll : list) {
+                    dlls.files.insert(dll.fileName().toUpper(), dll.absoluteFilePath());
+                }
+
+                dlls.listed = true;
+            }
+
+            auto path = dlls.files.value(name);
+            if (path.size()) {
+                result.push_back(path);
+            }
+        }
+
+        _envLookup.insert(key, result);
+        return result;
+    }
+#endif
+
+    if (!libName.contains('/') && !libName.contains('\\')) {
+        for (const auto &dir : _envirement) {
+            auto path = dir + "/" + libName;
 
+            if (!StatCache::isFile(path)) {
+                continue;
+            }
+
+#ifdef Q_OS_WIN
+            // restore the real case of the file name.
+            auto canonical = QFileInfo(path).canonicalFilePath();
+            if (canonical.size()) {
+                path = canonical;
+            }
+#endif
+            result.push_back(path);
+        }
     }
 
-    return res;
+    QWriteLocker locker(&_envLock);
+    _envLookup.insert(key, result);
+
+    return result;
 }
 
 bool DependenciesScanner::fillLibInfo(LibInfo &info, const QString &file) const {
@@ -91,17 +241,9 @@ void DependenciesScanner::recursiveDep(LibInfo &lib, QSet<LibInfo> &res, QSet<QS
     QuasarAppUtils::Params::log("get recursive dependencies of " + lib.fullPath(),
                                        QuasarAppUtils::Info);
 
-    if (_scanedLibs.contains(lib.fullPath())) {
-        auto scanedLib = _scanedLibs.value(lib.fullPath());
-
-        if (!scanedLib.isValid()) {
-            QuasarAppUtils::Params::log( "no valid lib in scaned libs list!",
-                                               QuasarAppUtils::Error);
-            return;
-        }
-
-        res.unite(scanedLib.allDep);
-
+    auto scaned = getScaned(lib.fullPath());
+    if (scaned.isValid()) {
+        res.unite(scaned.allDep);
         return;
     }
 
@@ -115,35 +257,47 @@ void DependenciesScanner::recursiveDep(LibInfo &lib, QSet<LibInfo> &res, QSet<QS
 
     for (auto i : lib.dependncies) {
 
-        auto libs = getLibsFromEnvirement(i);
+        LibInfo dep;
 
-        if (!libs.size()) {
+        if (!getLibFromEnvirement(i, lib.platform, dep)) {
             QuasarAppUtils::Params::log("lib for dependese " + i + " not findet!!",
                                                QuasarAppUtils::Warning);
             continue;
         }
 
-        auto dep = libs.begin();
+        if (isUnused(lib, dep)) {
+            QuasarAppUtils::Params::log("No symbols of " + dep.fullPath() + " are used by " +
+                                        lib.fullPath() + ", skip it",
+                                        QuasarAppUtils::Info);
+
+            auto size = QFileInfo(dep.fullPath()).size();
 
-        while (dep != libs.end() &&
-               dep.value().platform != lib.platform) dep++;
+            QWriteLocker locker(&_memoLock);
+            _prunedLibs.insert(dep.fullPath(), size);
+            _prunedNeeded[lib.fullPath()].insert(i);
+            continue;
+        }
 
-        if (dep != libs.end() && !res.contains(*dep)) {
-            res.insert(*dep);
+        if (!res.contains(dep)) {
+            res.insert(dep);
 
-            LibInfo scanedLib = _scanedLibs.value(dep->fullPath());
+            LibInfo scanedLib = getScaned(dep.fullPath());
 
             if (!scanedLib.isValid()) {
                 QSet<LibInfo> listDep =  {};
 
-                if (!lib.name.compare(dep.value().name, ONLY_WIN_CASE_INSENSIATIVE))
+                if (!lib.name.compare(dep.name, ONLY_WIN_CASE_INSENSIATIVE))
                     continue;
 
-                recursiveDep(*dep, listDep, libStack);
+                recursiveDep(dep, listDep, libStack);
+
+                dep.allDep = listDep;
+                lib.setWinApi(lib.getWinApi() | dep.getWinApi());
 
-                dep->allDep = listDep;
-                lib.setWinApi(lib.getWinApi() | dep->getWinApi());
-                _scanedLibs.insert(dep->fullPath(), *dep);
+                // the other thread can scan the same library at the same time, both results are equal.
+                _memoLock.lockForWrite();
+                _scanedLibs.insert(dep.fullPath(), dep);
+                _memoLock.unlock();
 
                 res.unite(listDep);
             } else {
@@ -156,9 +310,48 @@ void DependenciesScanner::recursiveDep(LibInfo &lib, QSet<LibInfo> &res, QSet<QS
     libStack.remove(lib.fullPath());
 }
 
+DependenciesScanner::Symbols DependenciesScanner::getSymbols(const QString &lib) {
+    {
+        QReadLocker locker(&_memoLock);
+        auto it = _symbols.constFind(lib);
+
+        if (it != _symbols.cend()) {
+            return *it;
+        }
+    }
+
+    Symbols symbols;
+    symbols.valid = _elfScaner.getSymbols(lib, symbols.undefinedSymbols, symbols.definedSymbols);
+
+    QWriteLocker locker(&_memoLock);
+    _symbols.insert(lib, symbols);
+
+    return symbols;
+}
+
+bool DependenciesScanner::isUnused(const LibInfo &lib, const LibInfo &dependency) {
+    if (!_pruneMode ||
+            getScaner(lib.fullPath()) != PrivateScaner::ELF ||
+            getScaner(dependency.fullPath()) != PrivateScaner::ELF) {
+        return false;
+    }
+
+    const auto libSymbols = getSymbols(lib.fullPath());
+    const auto depSymbols = getSymbols(dependency.fullPath());
+
+    // keep the dependency if symbols can not be read, the pruning must not break the distribution.
+    if (!libSymbols.valid || !depSymbols.valid || depSymbols.definedSymbols.isEmpty()) {
+        return false;
+    }
+
+    return !libSymbols.undefinedSymbols.intersects(depSymbols.definedSymbols);
+}
+
 void DependenciesScanner::addToWinAPI(const QString &lib, QHash<WinAPI, QSet<QString>>& res) {
 #ifdef Q_OS_WIN
-    if (QuasarAppUtils::Params::isEndable("deploySystem")) {
+    // only the api set contracts are grouped, other libraries are not api sets.
+    if (QuasarAppUtils::Params::isEndable("deploySystem") &&
+            lib.startsWith("API-MS-WIN", Qt::CaseInsensitive)) {
         WinAPI api = _peScaner.getAPIModule(lib);
         if (api != WinAPI::NoWinAPI) {
             res[api] += lib;
@@ -171,32 +364,95 @@ void DependenciesScanner::addToWinAPI(const QString &lib, QHash<WinAPI, QSet<QSt
 #endif
 }
 
+QByteArray DependenciesScanner::configKey(const QStringList &env) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // the target and the app dirs change the environment only through the ignore list,
+    // which is already a part of the env, so the jobs with different targetDir share the cache.
+    hash.addData(env.join('\n').toUtf8());
+
+    for (const auto &key : {"deploySystem", "deploySystem-with-libc", "qmake", "ignore", "ignoreEnv",
+                            "noRecursiveiIgnoreEnv", "extraLibs", "libDir", "recursiveDepth",
+                            "pruneUnusedLibs"}) {
+        if (QuasarAppUtils::Params::isEndable(key)) {
+            hash.addData((QString(key) + "=" + QuasarAppUtils::Params::getStrArg(key) + "\n").toUtf8());
+        }
+    }
+
+    if (auto config = DeployCore::_config) {
+        hash.addData((config->qtDir.getLibs() + "\n" +
+                      config->qtDir.getBins() + "\n").toUtf8());
+    }
+
+    return hash.result();
+}
+
 void DependenciesScanner::setEnvironment(const QStringList &env) {
-    QDir dir;
     QHash<WinAPI, QSet<QString>> winAPI;
 
 #ifdef Q_OS_WIN
     winAPI[WinAPI::Crt] += "UCRTBASE.DLL";
 #endif
 
-    for (auto i : env) {
+    _pruneMode = QuasarAppUtils::Params::isEndable("pruneUnusedLibs");
+
+    // the priorities and the dependencies of the cached libraries depend on the options of the deploy,
+    // so the cache can be reused only by the deploys with the same options (server and batch modes).
+    auto key = configKey(env);
+    if (_configKey != key) {
+        _configKey = key;
+        clearScaned();
+    }
 
-        dir.setPath(i);
-        if (!dir.exists()) {
+    // the libraries are searched on demand, so only the list of the dirs is saved here.
+    QStringList envirement;
+    QHash<QString, QDateTime> modified;
+
+    for (const auto &i : env) {
+
+        auto stat = StatCache::stat(i);
+        if (!stat.isDir) {
             continue;
         }
 
-        auto list = dir.entryInfoList(QStringList() << "*.dll" << "*.DLL"
-                                      << "*.SO*" << "*.so*",
-                                      QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+        auto dir = QFileInfo(i).absoluteFilePath();
+        envirement.push_back(dir);
+        modified.insert(dir, stat.lastModified);
 
-        for (auto i : list) {
-            addToWinAPI(i.fileName().toUpper(), winAPI);
-            _EnvLibs.insertMulti(i.fileName().toUpper(), i.absoluteFilePath());
+#ifdef Q_OS_WIN
+        if (QuasarAppUtils::Params::isEndable("deploySystem")) {
+            // the api sets are not requested by name, collect them from the dirs.
+            for (const auto &lib : QDir(dir).entryList({"API-MS-WIN*"}, QDir::Files | QDir::Hidden)) {
+                addToWinAPI(lib.toUpper(), winAPI);
+            }
         }
+#endif
+    }
+
+    QWriteLocker locker(&_envLock);
+
+    // the found libraries stay valid while the envirement dirs are not modified,
+    // only the listings of the modified dirs are dropped.
+    bool changed = envirement != _envirement;
+
+    for (auto it = _envDlls.begin(); it != _envDlls.end();) {
+        if (!modified.contains(it.key()) || _envModified.value(it.key()) != modified.value(it.key())) {
+            it = _envDlls.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = modified.cbegin(); !changed && it != modified.cend(); ++it) {
+        changed = _envModified.value(it.key()) != it.value();
+    }
 
+    if (changed) {
+        _envLookup.clear();
     }
 
+    _envirement = envirement;
+    _envModified = modified;
 
     _peScaner.setWinAPI(winAPI);
 }
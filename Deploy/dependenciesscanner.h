@@ -8,7 +8,9 @@
 #ifndef WINDEPENDENCIESSCANNER_H
 #define WINDEPENDENCIESSCANNER_H
 
+#include <QDateTime>
 #include <QMultiMap>
+#include <QReadWriteLock>
 #include <QStringList>
 #include "deploy_global.h"
 #include "pe.h"
@@ -27,20 +29,117 @@ class DEPLOYSHARED_EXPORT DependenciesScanner {
 
 private:
 
-    QMultiHash<QString, QString> _EnvLibs;
+    /**
+     * @brief _envirement - dirs of the envirement in the search order.
+     */
+    QStringList _envirement;
+
+    /**
+     * @brief _envLookup - found paths of the requested libraries in the envirement order. key - name of the library.
+     *  Filled on demand by the findInEnvirement method and dropped by the setEnvironment method
+     *  when the list of the dirs or the modification time of any dir is changed.
+     */
+    mutable QHash<QString, QStringList> _envLookup;
+
+    /**
+     * @brief _envModified - modification times of the envirement dirs, saved by the setEnvironment method.
+     */
+    QHash<QString, QDateTime> _envModified;
+
+    /**
+     * @brief The EnvDlls struct - dlls of the one envirement dir. The dirs are listed only for the lookup of the dlls
+     *  on the case sensitive file systems (the names of the dlls are case insensitive).
+     */
+    struct EnvDlls {
+        bool listed = false;
+        QHash<QString, QString> files;
+    };
+
+    mutable QHash<QString, EnvDlls> _envDlls;
+    mutable QReadWriteLock _envLock;
+
     QHash<QString, LibInfo> _scanedLibs;
+    QDateTime _lastValidation;
+
+    /**
+     * @brief The Symbols struct - dynamic symbols of the elf file, used by the pruneUnusedLibs mode.
+     */
+    struct Symbols {
+        bool valid = false;
+        QSet<QByteArray> undefinedSymbols;
+        QSet<QByteArray> definedSymbols;
+    };
+
+    QHash<QString, Symbols> _symbols;
+    QHash<QString, qint64> _prunedLibs;
+
+    /**
+     * @brief _prunedNeeded - the pruned dependencies of the each library. key - path of the library,
+     *  value - names of the pruned dependencies (as the names of the dependencies of the LibInfo).
+     */
+    QHash<QString, QSet<QString>> _prunedNeeded;
+    bool _pruneMode = false;
+
+    /**
+     * @brief _configKey - key of the options of the deploy that change the scaned dependencies
+     *  (the envirement, the qt dir, the ignore list...). The cache of the scaned libraries is dropped when the key changes.
+     */
+    QByteArray _configKey;
+
+    /**
+     * @brief configKey
+     * @param env - the envirement of the deploy.
+     * @return key of the options of the deploy that change the scaned dependencies.
+     */
+    static QByteArray configKey(const QStringList &env);
+
+    /**
+     * @brief _memoLock - guard of the _scanedLibs, _symbols and _prunedLibs caches.
+     *  The scan method is called from the parallel deploy of the packages.
+     */
+    mutable QReadWriteLock _memoLock;
 
     PE _peScaner;
     ELF _elfScaner;
 
     PrivateScaner getScaner(const QString& lib) const;
 
-    QMultiMap<LibPriority, LibInfo> getLibsFromEnvirement(const QString& libName) const;
+    /**
+     * @brief getLibFromEnvirement - find the library in the envirement.
+     *  The candidates are checked in the priority order and only the first acceptable candidate is parsed.
+     * @param libName - name of the library.
+     * @param platform - platform of the dependent binary.
+     * @param result - information of the found library.
+     * @return true if the library found.
+     */
+    bool getLibFromEnvirement(const QString& libName, Platform platform, LibInfo& result) const;
+
+    /**
+     * @brief findInEnvirement - find the libraries with the name in the dirs of the envirement.
+     *  Only the requested name is checked in each dir, so the dirs are not listed.
+     * @return paths of the found libraries in the envirement order.
+     */
+    QStringList findInEnvirement(const QString& libName) const;
+
 
     void recursiveDep(LibInfo& lib, QSet<LibInfo> &res, QSet<QString> &libStack);
 
     void addToWinAPI(const QString& lib, QHash<WinAPI, QSet<QString> > &res);
 
+    Symbols getSymbols(const QString& lib);
+
+    /**
+     * @brief getScaned - get the library from the cache of scaned libraries.
+     * @return invalid LibInfo if the library not scaned yet.
+     */
+    LibInfo getScaned(const QString& lib) const;
+
+    /**
+     * @brief isUnused - check that the lib not uses any symbol of the dependency (pruneUnusedLibs mode).
+     * @return true if the dependency can be skipped.
+     */
+    bool isUnused(const LibInfo& lib, const LibInfo& dependency);
+
 public:
     explicit DependenciesScanner();
 
@@ -53,6 +152,31 @@ public:
 
     friend class deploytest;
     void clearScaned();
+
+    /**
+     * @brief clearScaned - remove from cache the libraries from list and all libraries that depend on them.
+     * @param libs - list of full paths to the changed libraries.
+     */
+    void clearScaned(const QSet<QString>& libs);
+
+    /**
+     * @brief clearOutdated - drop the cache of scaned libraries if any of them was changed after the previous call.
+     * Used by long-lived processes that run many deploys with the one scaner.
+     */
+    void clearOutdated();
+
+    /**
+     * @brief prunedLibs
+     * @return list of the libraries that were skipped by the pruneUnusedLibs mode. key - path, value - size of the library.
+     */
+    QHash<QString, qint64> prunedLibs() const;
+
+    /**
+     * @brief prunedNeeded
+     * @return the pruned dependencies of the scaned libraries. key - path of the library, value - names of the dependencies.
+     *  The deployed copies of the libraries must not require these dependencies (see ELF::removeNeeded).
+     */
+    QHash<QString, QSet<QString>> prunedNeeded() const;
 };
 
 #endif // WINDEPENDENCIESSCANNER_H
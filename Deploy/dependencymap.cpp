@@ -9,22 +9,91 @@
 #include "deploycore.h"
 #include "quasarapp.h"
 
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+namespace {
+QHash<QString, int> libraryIds;
+QVector<QString> libraryPaths;
+QReadWriteLock libraryIdsLock;
+
+/**
+ * @brief findLibraryId
+ * @return id of the library or -1 if the library is not interned.
+ */
+int findLibraryId(const QString& lib) {
+    QReadLocker lock(&libraryIdsLock);
+    return libraryIds.value(lib, -1);
+}
+
+int internLibrary(const QString& lib) {
+    auto id = findLibraryId(lib);
+    if (id >= 0) {
+        return id;
+    }
+
+    QWriteLocker lock(&libraryIdsLock);
+    auto it = libraryIds.find(lib);
+    if (it != libraryIds.end()) {
+        return it.value();
+    }
+
+    id = libraryPaths.size();
+    libraryPaths.push_back(lib);
+    libraryIds.insert(lib, id);
+
+    return id;
+}
+
+bool testLib(const QBitArray& libs, int id) {
+    return id >= 0 && id < libs.size() && libs.testBit(id);
+}
+
+void setLib(QBitArray& libs, int id) {
+    if (id >= libs.size()) {
+        libs.resize(qMax(id + 1, libs.size() * 2));
+    }
+
+    libs.setBit(id);
+}
+
+void subtractLibs(QBitArray& libs, const QBitArray& other) {
+    auto mask = other;
+    mask.resize(libs.size());
+    libs &= ~mask;
+}
+
+QSet<QString> toPaths(const QBitArray& libs) {
+    QSet<QString> result;
+
+    QReadLocker lock(&libraryIdsLock);
+    for (int id = 0; id < libs.size(); ++id) {
+        if (libs.testBit(id)) {
+            result.insert(libraryPaths[id]);
+        }
+    }
+
+    return result;
+}
+}
+
 DependencyMap::DependencyMap() {
     _qtModules = DeployCore::QtModule::NONE;
 }
 
 DependencyMap &DependencyMap::operator +=(const DependencyMap &other) {
     this->_qtModules = this->_qtModules | other._qtModules;
-    this->_neadedLibs = this->_neadedLibs + other._neadedLibs;
-    this->_systemLibs = this->_systemLibs + other._systemLibs;
+    this->_neadedLibs |= other._neadedLibs;
+    this->_systemLibs |= other._systemLibs;
 
     return *this;
 }
 
 DependencyMap &DependencyMap::operator -=(const DependencyMap &other) {
     this->_qtModules = this->_qtModules & (~other._qtModules);
-    this->_neadedLibs = this->_neadedLibs - other._neadedLibs;
-    this->_systemLibs = this->_systemLibs - other._systemLibs;
+    subtractLibs(this->_neadedLibs, other._neadedLibs);
+    subtractLibs(this->_systemLibs, other._systemLibs);
 
     return *this;
 }
@@ -33,12 +102,12 @@ DeployCore::QtModule DependencyMap::qtModules() const {
     return _qtModules;
 }
 
-const QSet<QString>& DependencyMap::neadedLibs() const {
-    return _neadedLibs;
+QSet<QString> DependencyMap::neadedLibs() const {
+    return toPaths(_neadedLibs);
 }
 
-const QSet<QString> &DependencyMap::systemLibs() const {
-    return _systemLibs;
+QSet<QString> DependencyMap::systemLibs() const {
+    return toPaths(_systemLibs);
 }
 
 void DependencyMap::addModule(DeployCore::QtModule module) {
@@ -47,11 +116,16 @@ void DependencyMap::addModule(DeployCore::QtModule module) {
 }
 
 void DependencyMap::addSystemLib(const QString &lib) {
-    _systemLibs.insert(lib);
+    setLib(_systemLibs, internLibrary(lib));
 }
 
 void DependencyMap::addNeadedLib(const QString &lib) {
-    _neadedLibs.insert(lib);
+    auto id = internLibrary(lib);
+    if (testLib(_neadedLibs, id)) {
+        return;
+    }
+
+    setLib(_neadedLibs, id);
     DeployCore::addQtModule(_qtModules, lib);
 }
 
@@ -60,15 +134,21 @@ void DependencyMap::removeModule(DeployCore::QtModule module) {
 }
 
 void DependencyMap::removeSystemLib(const QString &lib) {
-    _systemLibs.remove(lib);
+    auto id = findLibraryId(lib);
+    if (testLib(_systemLibs, id)) {
+        _systemLibs.clearBit(id);
+    }
 }
 
 void DependencyMap::removeNeadedLib(const QString &lib) {
-    _neadedLibs.remove(lib);
+    auto id = findLibraryId(lib);
+    if (testLib(_neadedLibs, id)) {
+        _neadedLibs.clearBit(id);
+    }
 }
 
 bool DependencyMap::containsSysLib(const QString &lib) const {
-    return _systemLibs.contains(lib);
+    return testLib(_systemLibs, findLibraryId(lib));
 }
 
 bool DependencyMap::containsModule(DeployCore::QtModule module) const {
@@ -76,7 +156,7 @@ bool DependencyMap::containsModule(DeployCore::QtModule module) const {
 }
 
 bool DependencyMap::containsNeadedLib(const QString &lib) const {
-    return _neadedLibs.contains(lib);
+    return testLib(_neadedLibs, findLibraryId(lib));
 }
 
 QSet<QString> DependencyMap::targets() const
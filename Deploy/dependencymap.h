@@ -10,11 +10,14 @@
 
 #include "deploy_global.h"
 #include "deploycore.h"
+#include <QBitArray>
 #include <QSet>
 
 /**
  * @brief The DependenciesMap class
  * this class contains all dependencies information about target
+ * The libraries are stored as bits of the run-wide table of the library ids,
+ * so the merge and the diff of the maps do not copy the path strings.
  */
 class DEPLOYSHARED_EXPORT DependencyMap
 {
@@ -25,8 +28,8 @@ public:
     DependencyMap& operator -=(const DependencyMap& other);
 
     DeployCore::QtModule qtModules() const;
-    const QSet<QString>& neadedLibs() const;
-    const QSet<QString>& systemLibs() const;
+    QSet<QString> neadedLibs() const;
+    QSet<QString> systemLibs() const;
 
     void addModule(DeployCore::QtModule module);
     void addSystemLib(const QString& lib);
@@ -46,8 +49,8 @@ public:
 private:
     DeployCore::QtModule _qtModules = DeployCore::NONE;
 
-    QSet<QString> _neadedLibs;
-    QSet<QString> _systemLibs;
+    QBitArray _neadedLibs;
+    QBitArray _systemLibs;
     QSet<QString> _targets;
 };
 
@@ -7,9 +7,16 @@
 
 #include "configparser.h"
 #include "deploy.h"
+#include "deploycore.h"
+#include "deploywatcher.h"
 #include "extracter.h"
 #include "filemanager.h"
+#include "fingerprint.h"
 #include "packing.h"
+#include "statcache.h"
+#include "verifier.h"
+#include <QDir>
+#include <QFileInfo>
 #include <quasarapp.h>
 
 Deploy::Deploy() {
@@ -20,29 +27,154 @@ Deploy::Deploy() {
 
 }
 
+Deploy::Deploy(DependenciesScanner *scaner) {
+    _fileManager = new FileManager();
+    _scaner = scaner;
+    _ownScaner = false;
+    _packing = new Packing();
+    _paramsParser = new ConfigParser(_fileManager, _scaner, _packing);
+
+}
+
 int Deploy::run() {
 
+    // the metadata of the files and the found executables are cached only during the one deploy.
+    StatCache::clear();
+    DeployCore::clearProcessCache();
+
+    if (isUnchanged()) {
+        QuasarAppUtils::Params::log("The inputs of the deploy are not changed, the deploy is skipped.",
+                                    QuasarAppUtils::Info);
+        return Good;
+    }
+
     if (!prepare()) {
         return PrepareError;
     }
 
-    _fileManager->loadDeployemendFiles(_paramsParser->config()->getTargetDir());
+    auto cnf = _paramsParser->config();
+
+    if (!isAllowedTargetDir(cnf->getTargetDir())) {
+        QuasarAppUtils::Params::log("The target dir " + cnf->getTargetDir() + " is not allowed",
+                                    QuasarAppUtils::Error);
+        return PrepareError;
+    }
+
+    _fileManager->loadDeployemendFiles(cnf->getTargetDir());
 
     if (!deploy()) {
         return DeployError;
     }
 
     if (!packing()) {
-        _fileManager->saveDeploymendFiles(_paramsParser->config()->getTargetDir());
+        _fileManager->saveDeploymendFiles(cnf->getTargetDir());
         return PackingError;
     }
-    _fileManager->saveDeploymendFiles(_paramsParser->config()->getTargetDir());
+
+    if (_inputsFingerprint.size()) {
+        auto dirs = Fingerprint::installationDirs(cnf);
+        _fileManager->saveDeploymendFiles(cnf->getTargetDir(),
+                                          Fingerprint::compute(_inputsFingerprint, dirs),
+                                          dirs);
+    } else {
+        _fileManager->saveDeploymendFiles(cnf->getTargetDir());
+    }
 
     return Good;
 }
 
+bool Deploy::isUnchanged() {
+    if (!QuasarAppUtils::Params::isEndable("skipUnchanged") ||
+            QuasarAppUtils::Params::isEndable("clear") ||
+            QuasarAppUtils::Params::isEndable("force-clear") ||
+            QuasarAppUtils::Params::isEndable("watch")) {
+        return false;
+    }
+
+    // errors of the config file will be printed by the parseParams method.
+    if (!_paramsParser->loadConfFile() || DeployCore::getMode() != RunMode::Deploy) {
+        return false;
+    }
+
+    _inputsFingerprint = Fingerprint::inputs();
+    if (_inputsFingerprint.isEmpty()) {
+        return false;
+    }
+
+    auto targetDir = Fingerprint::targetDir();
+    if (!isAllowedTargetDir(targetDir)) {
+        return false;
+    }
+
+    QStringList dirs;
+    auto fingerprint = _fileManager->loadFingerprint(targetDir, dirs);
+
+    if (fingerprint.isEmpty() || fingerprint != Fingerprint::compute(_inputsFingerprint, dirs)) {
+        return false;
+    }
+
+    _fileManager->loadDeployemendFiles(targetDir);
+    const auto deployedFiles = _fileManager->getDeployedFiles();
+
+    if (deployedFiles.isEmpty()) {
+        return false;
+    }
+
+    for (const auto &file : deployedFiles) {
+        if (!QFileInfo::exists(file)) {
+            QuasarAppUtils::Params::log("The deployed file " + file + " not exists, the deploy is needed.",
+                                        QuasarAppUtils::Info);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Deploy::isAllowedTargetDir(const QString &targetDir) const {
+    if (_allowedTargetDirs.isEmpty()) {
+        return true;
+    }
+
+    auto path = QDir::cleanPath(QFileInfo(targetDir).absoluteFilePath());
+
+    for (const auto &dir : _allowedTargetDirs) {
+        auto allowed = QDir::cleanPath(dir);
+
+        if (path.compare(allowed, ONLY_WIN_CASE_INSENSIATIVE) == 0 ||
+                path.startsWith(allowed + "/", ONLY_WIN_CASE_INSENSIATIVE)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Deploy::setAllowedTargetDirs(const QStringList &dirs) {
+    _allowedTargetDirs = dirs;
+}
+
+bool Deploy::watch() {
+    if (!_extracter || DeployCore::getMode() != RunMode::Deploy) {
+        QuasarAppUtils::Params::log("The watch mode works only after the deploy",
+                                    QuasarAppUtils::Error);
+        return false;
+    }
+
+    if (!_watcher) {
+        _watcher = new DeployWatcher(_extracter, _fileManager,
+                                     _paramsParser->config()->getTargetDir());
+    }
+
+    return _watcher->start();
+}
+
 Deploy::~Deploy() {
 
+    if (_watcher) {
+        delete _watcher;
+    }
+
     if (_extracter) {
         delete _extracter;
     }
@@ -55,7 +187,7 @@ Deploy::~Deploy() {
         delete _fileManager;
     }
 
-    if (_scaner) {
+    if (_scaner && _ownScaner) {
         delete _scaner;
     }
 
@@ -84,7 +216,13 @@ bool Deploy::deploy() {
     switch (DeployCore::getMode() ) {
     case RunMode::Deploy:
         _extracter->deploy();
+
+        if (QuasarAppUtils::Params::isEndable("verify")) {
+            return Verifier(_scaner).verify();
+        }
         break;
+    case RunMode::Verify:
+        return Verifier(_scaner).verify();
     case RunMode::Clear:
         _extracter->clear();
         break;
@@ -8,6 +8,8 @@
 #ifndef DEPLOY_H
 #define DEPLOY_H
 
+#include <QByteArray>
+#include <QStringList>
 #include "deploy_global.h"
 
 
@@ -16,6 +18,7 @@ class Extracter;
 class FileManager;
 class DependenciesScanner;
 class Packing;
+class DeployWatcher;
 
 enum exitCodes {
     Good =          0x0,
@@ -35,6 +38,32 @@ private:
     FileManager *_fileManager = nullptr;
     DependenciesScanner *_scaner = nullptr;
     Packing *_packing = nullptr;
+    DeployWatcher *_watcher = nullptr;
+
+    /**
+     * @brief _ownScaner - false if the scaner was provided by the caller (for example by the DeployServer)
+     */
+    bool _ownScaner = true;
+
+    /**
+     * @brief _inputsFingerprint - fingerprint of the inputs of the deploy, used by the skipUnchanged option.
+     */
+    QByteArray _inputsFingerprint;
+
+    /**
+     * @brief _allowedTargetDirs - the target dir of the deploy must be inside one of these dirs.
+     *  The empty list allows any target dir.
+     */
+    QStringList _allowedTargetDirs;
+
+    bool isAllowedTargetDir(const QString& targetDir) const;
+
+    /**
+     * @brief isUnchanged - check that the inputs of the deploy not changed after the previous deploy and all deployed files exist.
+     *  Works only with the skipUnchanged option.
+     * @return true if the deploy can be skipped.
+     */
+    bool isUnchanged();
 
     bool prepare();
     bool deploy();
@@ -43,7 +72,28 @@ private:
 
 public:
     Deploy();
+
+    /**
+     * @brief Deploy - create a deploy object that uses the external dependencies scaner.
+     * The scaner keeps the cache of scaned libraries and the envirement index between runs.
+     * @param scaner - shared scaner, the deploy object does not take ownership of it.
+     */
+    explicit Deploy(DependenciesScanner *scaner);
     int run();
+
+    /**
+     * @brief setAllowedTargetDirs - restrict the target dirs of the deploy.
+     *  Used by the deploy server for the requests of the clients.
+     * @param dirs - absolute paths of the allowed dirs. The empty list allows any target dir.
+     */
+    void setAllowedTargetDirs(const QStringList& dirs);
+
+    /**
+     * @brief watch - start watching the sources of the finished deploy.
+     * Changes of the sources will be redeployed incrementally. Requires the running event loop.
+     * @return true if the watcher started successful.
+     */
+    bool watch();
     ~Deploy();
 
     friend class deploytest;
@@ -5,79 +5,156 @@
  * of this license document, but changing it is not allowed.
  */
 
+#include "binarysniffer.h"
 #include "extracter.h"
 #include "deploycore.h"
 #include "quasarapp.h"
 #include "pathutils.h"
+#include "statcache.h"
 
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QLibraryInfo>
+#include <QMutex>
 #include <configparser.h>
 #include <iostream>
 
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
 //QString DeployCore::qtDir = "";
 //QStringList DeployCore::extraPaths = QStringList();
 
 
 const DeployConfig* DeployCore::_config = nullptr;
 
-QtModuleEntry DeployCore::qtModuleEntries[] = {
-    { QtBluetoothModule, "bluetooth", "Qt5Bluetooth", nullptr },
-    { QtConcurrentModule, "concurrent", "Qt5Concurrent", "qtbase" },
-    { QtCoreModule, "core", "Qt5Core", "qtbase" },
-    { QtDeclarativeModule, "declarative", "Qt5Declarative", "qtquick1" },
-    { QtDesignerModule, "designer", "Qt5Designer", nullptr },
-    { QtDesignerComponents, "designercomponents", "Qt5DesignerComponents", nullptr },
-    { QtEnginioModule, "enginio", "Enginio", nullptr },
-    { QtGamePadModule, "gamepad", "Qt5Gamepad", nullptr },
-    { QtGuiModule, "gui", "Qt5Gui", "qtbase" },
-    { QtHelpModule, "qthelp", "Qt5Help", "qt_help" },
-    { QtMultimediaModule, "multimedia", "Qt5Multimedia", "qtmultimedia" },
-    { QtMultimediaWidgetsModule, "multimediawidgets", "Qt5MultimediaWidgets", "qtmultimedia" },
-    { QtMultimediaQuickModule, "multimediaquick", "Qt5MultimediaQuick_p", "qtmultimedia" },
-    { QtNetworkModule, "network", "Qt5Network", "qtbase" },
-    { QtNfcModule, "nfc", "Qt5Nfc", nullptr },
-    { QtOpenGLModule, "opengl", "Qt5OpenGL", nullptr },
-    { QtPositioningModule, "positioning", "Qt5Positioning", nullptr },
-    { QtPrintSupportModule, "printsupport", "Qt5PrintSupport", nullptr },
-    { QtQmlModule, "qml", "Qt5Qml", "qtdeclarative" },
-    { QtQmlToolingModule, "qmltooling", "qmltooling", nullptr },
-    { QtQuickModule, "quick", "Qt5Quick", "qtdeclarative" },
-    { QtQuickParticlesModule, "quickparticles", "Qt5QuickParticles", nullptr },
-    { QtQuickWidgetsModule, "quickwidgets", "Qt5QuickWidgets", nullptr },
-    { QtScriptModule, "script", "Qt5Script", "qtscript" },
-    { QtScriptToolsModule, "scripttools", "Qt5ScriptTools", "qtscript" },
-    { QtSensorsModule, "sensors", "Qt5Sensors", nullptr },
-    { QtSerialPortModule, "serialport", "Qt5SerialPort", "qtserialport" },
-    { QtSqlModule, "sql", "Qt5Sql", "qtbase" },
-    { QtSvgModule, "svg", "Qt5Svg", nullptr },
-    { QtTestModule, "test", "Qt5Test", "qtbase" },
-    { QtWebKitModule, "webkit", "Qt5WebKit", nullptr },
-    { QtWebKitWidgetsModule, "webkitwidgets", "Qt5WebKitWidgets", nullptr },
-    { QtWebSocketsModule, "websockets", "Qt5WebSockets", nullptr },
-    { QtWidgetsModule, "widgets", "Qt5Widgets", "qtbase" },
-    { QtWinExtrasModule, "winextras", "Qt5WinExtras", nullptr },
-    { QtXmlModule, "xml", "Qt5Xml", "qtbase" },
-    { QtXmlPatternsModule, "xmlpatterns", "Qt5XmlPatterns", "qtxmlpatterns" },
-    { QtWebEngineCoreModule, "webenginecore", "Qt5WebEngineCore", nullptr },
-    { QtWebEngineModule, "webengine", "Qt5WebEngine", "qtwebengine" },
-    { QtWebEngineWidgetsModule, "webenginewidgets", "Qt5WebEngineWidgets", nullptr },
-    { Qt3DCoreModule, "3dcore", "Qt53DCore", nullptr },
-    { Qt3DRendererModule, "3drenderer", "Qt53DRender", nullptr },
-    { Qt3DQuickModule, "3dquick", "Qt53DQuick", nullptr },
-    { Qt3DQuickRendererModule, "3dquickrenderer", "Qt53DQuickRender", nullptr },
-    { Qt3DInputModule, "3dinput", "Qt53DInput", nullptr },
-    { Qt3DAnimationModule, "3danimation", "Qt53DAnimation", nullptr },
-    { Qt3DExtrasModule, "3dextras", "Qt53DExtras", nullptr },
-    { QtLocationModule, "geoservices", "Qt5Location", nullptr },
-    { QtWebChannelModule, "webchannel", "Qt5WebChannel", nullptr },
-    { QtTextToSpeechModule, "texttospeech", "Qt5TextToSpeech", nullptr },
-    { QtSerialBusModule, "serialbus", "Qt5SerialBus", nullptr },
-    { QtWebViewModule, "webview", "Qt5WebView", nullptr }
+
+namespace {
+
+constexpr int qtModulesCount = sizeof(DeployCore::qtModuleEntries) / sizeof(QtModuleEntry);
+constexpr quint32 qtModulesTableSize = 512;
+
+static_assert(qtModulesCount < 128, "the index of the module must fit to qint8");
+static_assert(qtModulesCount < static_cast<int>(qtModulesTableSize) / 4,
+              "the table of the qt modules is too dense");
+
+constexpr quint32 toLowerAscii(quint32 symbol) {
+    return (symbol >= 'A' && symbol <= 'Z')? symbol - 'A' + 'a': symbol;
+}
+
+constexpr quint32 moduleHashStep(quint32 hash, quint32 symbol) {
+    return (hash ^ toLowerAscii(symbol)) * 16777619u;
+}
+
+/**
+ * @brief moduleHash - case-insensitive FNV-1a hash of the library stem.
+ */
+constexpr quint32 moduleHash(const char *stem, quint32 seed) {
+    quint32 hash = 2166136261u ^ seed;
+    for (; *stem; ++stem) {
+        hash = moduleHashStep(hash, static_cast<quint8>(*stem));
+    }
+
+    return hash & (qtModulesTableSize - 1);
+}
+
+quint32 moduleHash(const QStringRef &stem, quint32 seed) {
+    quint32 hash = 2166136261u ^ seed;
+    for (const QChar &symbol : stem) {
+        hash = moduleHashStep(hash, symbol.unicode());
+    }
+
+    return hash & (qtModulesTableSize - 1);
+}
+
+struct QtModulesTable {
+    quint32 seed = 0;
+    qint8 indexes[qtModulesTableSize] = {};
 };
 
+constexpr bool isPerfectSeed(quint32 seed) {
+    bool used[qtModulesTableSize] = {};
+    for (int i = 0; i < qtModulesCount; ++i) {
+        auto index = moduleHash(DeployCore::qtModuleEntries[i].libraryName, seed);
+        if (used[index]) {
+            return false;
+        }
+
+        used[index] = true;
+    }
+
+    return true;
+}
+
+constexpr QtModulesTable createQtModulesTable() {
+    QtModulesTable table;
+    while (!isPerfectSeed(table.seed)) {
+        ++table.seed;
+    }
+
+    for (auto &index : table.indexes) {
+        index = -1;
+    }
+
+    for (int i = 0; i < qtModulesCount; ++i) {
+        table.indexes[moduleHash(DeployCore::qtModuleEntries[i].libraryName, table.seed)] =
+                static_cast<qint8>(i);
+    }
+
+    return table;
+}
+
+constexpr QtModulesTable qtModulesTable = createQtModulesTable();
+
+const QtModuleEntry* findQtModuleByStem(const QStringRef &stem) {
+    auto index = qtModulesTable.indexes[moduleHash(stem, qtModulesTable.seed)];
+    if (index < 0) {
+        return nullptr;
+    }
+
+    const auto &entry = DeployCore::qtModuleEntries[index];
+    if (stem.compare(QLatin1String(entry.libraryName), Qt::CaseInsensitive)) {
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+/**
+ * @brief findQtModule - find the qt module of the library.
+ * @param path - path or file name of the library (libQt5Core.so.5, Qt5Cored.dll).
+ * @return entry of the module or nullptr if the library is not a qt module.
+ */
+const QtModuleEntry* findQtModule(const QString &path) {
+    int begin = path.lastIndexOf('/') + 1;
+    begin = qMax(begin, path.lastIndexOf('\\') + 1);
+
+    if (path.midRef(begin, 3).compare(QLatin1String("lib"), Qt::CaseInsensitive) == 0) {
+        begin += 3;
+    }
+
+    int end = path.indexOf('.', begin);
+    if (end < 0) {
+        end = path.size();
+    }
+
+    auto stem = path.midRef(begin, end - begin);
+    if (auto entry = findQtModuleByStem(stem)) {
+        return entry;
+    }
+
+    // debug build of the qt on windows (Qt5Cored.dll)
+    if (stem.endsWith('d')) {
+        return findQtModuleByStem(stem.chopped(1));
+    }
+
+    return nullptr;
+}
+}
+
 DeployCore::QtModule DeployCore::getQtModule(const QString& path) {
     auto priority = DeployCore::getLibPriority(path);
 
@@ -85,14 +162,8 @@ DeployCore::QtModule DeployCore::getQtModule(const QString& path) {
         return DeployCore::QtModule::NONE;
     }
 
-    int modulesCount = sizeof (qtModuleEntries) / sizeof (QtModuleEntry);
-
-    auto lIbName = QFileInfo(path).fileName();
-
-    for (int i = 0; i < modulesCount; ++i) {
-        if (lIbName.contains(qtModuleEntries[i].libraryName)) {
-            return static_cast<DeployCore::QtModule>(qtModuleEntries[i].module);
-        }
+    if (auto entry = findQtModule(path)) {
+        return static_cast<DeployCore::QtModule>(entry->module);
     }
 
     return DeployCore::QtModule::NONE;
@@ -100,14 +171,16 @@ DeployCore::QtModule DeployCore::getQtModule(const QString& path) {
 
 void DeployCore::addQtModule(DeployCore::QtModule &module, const QString &path) {
 
-    QuasarAppUtils::Params::log("current module " + QString::number(module),
-                                       QuasarAppUtils::Info);
-
     auto mod = getQtModule(path);
-    QuasarAppUtils::Params::log("add new module from path " + path  +
-                                       " module value " + QString::number(mod),
-                                       QuasarAppUtils::Info);
 
+    // do not build the log messages for each library when they will not be printed.
+    if (QuasarAppUtils::Params::getStrArg("verbose", "1").toInt() >= QuasarAppUtils::Info) {
+        QuasarAppUtils::Params::log("current module " + QString::number(module),
+                                    QuasarAppUtils::Info);
+        QuasarAppUtils::Params::log("add new module from path " + path  +
+                                    " module value " + QString::number(mod),
+                                    QuasarAppUtils::Info);
+    }
 
     module = static_cast<DeployCore::QtModule>(
                 static_cast<quint64>(module) | static_cast<quint64>(mod));
@@ -117,7 +190,7 @@ void DeployCore::addQtModule(DeployCore::QtModule &module, const QString &path)
 
 LibPriority DeployCore::getLibPriority(const QString &lib) {
 
-    if (!QFileInfo(lib).isFile()) {
+    if (!StatCache::isFile(lib)) {
         return NotFile;
     }
 
@@ -150,6 +223,10 @@ RunMode DeployCore::getMode() {
         return RunMode::Deploy;
     }
 
+    if (C("verify")) {
+        return RunMode::Verify;
+    }
+
     if (C("clear") || C("force-clear")) {
         return RunMode::Clear;
     }
@@ -190,6 +267,22 @@ void DeployCore::help() {
                 {"qif", "Create the QIF installer for deployement programm"},
                 {"deploySystem", "Deploys all libraries  (do not work in snap )"},
                 {"deploySystem-with-libc", "deploy all libs libs (only linux) (do not work in snap )"},
+                {"pruneUnusedLibs", "Skips the linked libraries whose exported symbols are not used by the dependent binary"
+                 " (only linux). Useful for binaries linked without --as-needed"},
+                {"patchRunPath", "Rewrites the run path of the deployed elf files to $ORIGIN-relative path of the lib dir"
+                 " (only linux). The binaries can be launched without the run scripts."
+                 " The new path can not be longer than the existing run path of the file"},
+                {"verify", "Checks that all dependencies of the deployed binaries are found inside the distribution"
+                 " (targetDir) without running the application. Reports missing libraries and libraries loaded from the host."
+                 " Can be used with the -bin option for check the distribution after deploy"},
+                {"qmlCacheGen", "Creates the qml disk cache (.qmlc and .jsc files) for the deployed qml files"
+                 " with the qmlcachegen of the Qt. Reduces the start time of the qml applications"},
+                {"watch", "After deployment, watches the targets, qml sources and extra libraries"
+                 " and redeploys only changed files and their dependencies. Stop with Ctrl+C"},
+                {"skipUnchanged", "Skips the deploy if the parameters, the targets and the Qt installation"
+                 " are not changed after the previous deploy and all deployed files exist"},
+                {"noRunQmake", "Reads the paths of the Qt from the qt.conf and the layout of the Qt installation"
+                 " instead of running the qmake -query command. The results of the qmake -query are cached by default"},
 
             }
         },
@@ -200,7 +293,9 @@ void DeployCore::help() {
                 {"-confFile [params]", "The path to the json file with all deployment configurations. Using this file,"
                  " you can add the necessary options, thereby simplifying the command invocation in the console."
                  " However, the parameters in Kansol have a higher priority than in the file."
-                 " For more info about this flag see https://github.com/QuasarApp/CQtDeployer/wiki/DeployConfigFileEn"},
+                 " For more info about this flag see https://github.com/QuasarApp/CQtDeployer/wiki/DeployConfigFileEn."
+                 " If you set a list of files (-confFile app1.json,app2.json) then all configurations"
+                 " will be deployed in one process with the shared cache of scaned libraries"},
                 {"-qmlDir [params]", "Qml data dir. For example -qmlDir ~/my/project/qml"},
                 {"-qmake [params]", "Deployable file or folder. For example -bin ~/my/project/bin/,~/my/project/bin.exe"},
                 {"-ignore [list,params]", "The list of libs to ignore. For example -ignore libicudata.so.56,libicudata2.so.56"},
@@ -213,7 +308,16 @@ void DeployCore::help() {
                 {"-extraPlugin [list,params]", "Sets an additional path to extraPlugin of an app"},
                 {"-recursiveDepth [params]", "Sets the Depth of recursive search of libs and depth for ignoreEnv option (default 0)"},
                 {"-targetDir [params]", "Sets target directory(by default it is the path to the first deployable file)"},
+                {"-debugDir [path]", "Saves the debug info of the deployed libraries into the build-id indexed tree"
+                 " (path/.build-id/xx/yyyy.debug) before strip and adds the debuglink to the stripped files (only linux)."
+                 " Does not work with the noStrip option"},
                 {"-verbose [0-3]", "Shows debug log"},
+                {"-server [socketName]", "Starts the resident deploy server. The server keeps the cache of scaned libraries,"
+                 " the envirement index and the qmake query results between deploys. By default socketName is cqtdeployer."
+                 " Only the user of the server can send requests, and the requests can deploy only into the"
+                 " targetDir of the server (by default the working directory of the server)"},
+                {"-connect [socketName]", "Sends the deploy request with all other options to the running deploy server"
+                 " and waits for the result. For example: cqtdeployer -connect cqtdeployer -bin myApp"},
 
             }
         },
@@ -274,9 +378,15 @@ QStringList DeployCore::helpKeys() {
         "targetDir",
         "targetPackage",
         "noStrip",
+        "debugDir",
         "extractPlugins",
+        "pruneUnusedLibs",
+        "patchRunPath",
+        "qmlCacheGen",
+        "skipUnchanged",
+        "noRunQmake",
         "noTranslations",
-        "noRecursiveiIgnoreEnv"
+        "noRecursiveiIgnoreEnv",
         "qmlOut",
         "libOut",
         "trOut",
@@ -303,14 +413,11 @@ QStringList DeployCore::helpKeys() {
 
 QStringList DeployCore::extractTranslation(const QSet<QString> &libs) {
     QSet<QString> res;
-    const size_t qtModulesCount = sizeof(qtModuleEntries) / sizeof(QtModuleEntry);
 
     for (const auto &lib: libs) {
-        for (size_t i = 0; i < qtModulesCount; ++i) {
-            if (lib.contains(qtModuleEntries[i].libraryName) &&
-                    qtModuleEntries[i].translation) {
-                res.insert(qtModuleEntries[i].translation);
-            }
+        auto entry = findQtModule(lib);
+        if (entry && entry->translation) {
+            res.insert(entry->translation);
         }
     }
     return res.values();
@@ -338,6 +445,10 @@ void DeployCore::printVersion() {
 }
 
 bool DeployCore::isExecutable(const QFileInfo& file) {
+    if (file.isFile()) {
+        return BinarySniffer::sniff(file.absoluteFilePath()).isExecutable();
+    }
+
     auto sufix = file.completeSuffix();
     return sufix.contains("exe", Qt::CaseInsensitive) || sufix.contains("run", Qt::CaseInsensitive) || sufix.isEmpty();
 }
@@ -351,15 +462,52 @@ bool DeployCore::isContainsArraySeparators(const QString &val, int lastLvl) {
     return false;
 }
 
+/**
+ * foundProcesses - memo of the DeployCore::findProcess. key - env and name of the process, value - path to the executable.
+ * Only found executables are saved, they are checked again before use. Cleared by the DeployCore::clearProcessCache.
+ */
+static QHash<QString, QString> foundProcesses;
+static QMutex foundProcessesMutex;
+
+static bool isExecutableFile(const QString& path) {
+#ifdef Q_OS_UNIX
+    if (access(QFile::encodeName(path).constData(), X_OK) != 0) {
+        return false;
+    }
+#endif
+    return StatCache::isFile(path);
+}
+
 QString DeployCore::findProcess(const QString &env, const QString& proc) {
-    auto list = env.split(DeployCore::getEnvSeparator());
+    auto key = env + "\n" + proc;
+
+    {
+        QMutexLocker locker(&foundProcessesMutex);
+        auto it = foundProcesses.constFind(key);
+        if (it != foundProcesses.constEnd() && isExecutableFile(*it)) {
+            return *it;
+        }
+    }
+
+#ifdef Q_OS_WIN
+    const QStringList sufixes = {"", ".exe", ".bat", ".cmd"};
+#else
+    const QStringList sufixes = {""};
+#endif
+
+    const auto list = env.split(DeployCore::getEnvSeparator(), QString::SkipEmptyParts);
 
     for (const auto& path : list) {
-        auto files = QDir(path).entryInfoList(QDir::NoDotAndDotDot | QDir::Files);
+        for (const auto& sufix : sufixes) {
+            auto candidate = QDir::fromNativeSeparators(path) + "/" + proc + sufix;
+
+            if (isExecutableFile(candidate)) {
+                auto result = QFileInfo(candidate).absoluteFilePath();
 
-        for (const auto& bin : files) {
-            if (bin.baseName().compare(proc, ONLY_WIN_CASE_INSENSIATIVE) == 0) {
-                return bin.absoluteFilePath();
+                QMutexLocker locker(&foundProcessesMutex);
+                foundProcesses.insert(key, result);
+
+                return result;
             }
         }
     }
@@ -367,6 +515,11 @@ QString DeployCore::findProcess(const QString &env, const QString& proc) {
     return "";
 }
 
+void DeployCore::clearProcessCache() {
+    QMutexLocker locker(&foundProcessesMutex);
+    foundProcesses.clear();
+}
+
 int DeployCore::find(const QString &str, const QStringList &list) {
     for (int i = 0 ; i < list.size(); ++i) {
         if (list[i].contains(str))
@@ -376,6 +529,10 @@ int DeployCore::find(const QString &str, const QStringList &list) {
 }
 
 bool DeployCore::isLib(const QFileInfo &file) {
+    if (file.isFile()) {
+        return BinarySniffer::sniff(file.absoluteFilePath()).isLib;
+    }
+
     return file.completeSuffix().contains("so", Qt::CaseInsensitive)
             || file.completeSuffix().contains("dll", Qt::CaseInsensitive);
 }
@@ -67,7 +67,8 @@ enum class RunMode: int {
     Info,
     Deploy,
     Clear,
-    Init
+    Init,
+    Verify
 };
 
 class Extracter;
@@ -140,8 +141,65 @@ public:
 
     DeployCore() = delete;
 
+    /**
+     * @brief qtModuleEntries - known qt modules. The libraryName field is the file stem of the module library,
+     * the DeployCore::getQtModule method looks up it in the perfect hash table built from this list at compile time.
+     */
+    static constexpr QtModuleEntry qtModuleEntries[] = {
+        { QtBluetoothModule, "bluetooth", "Qt5Bluetooth", nullptr },
+        { QtConcurrentModule, "concurrent", "Qt5Concurrent", "qtbase" },
+        { QtCoreModule, "core", "Qt5Core", "qtbase" },
+        { QtDeclarativeModule, "declarative", "Qt5Declarative", "qtquick1" },
+        { QtDesignerModule, "designer", "Qt5Designer", nullptr },
+        { QtDesignerComponents, "designercomponents", "Qt5DesignerComponents", nullptr },
+        { QtEnginioModule, "enginio", "Enginio", nullptr },
+        { QtGamePadModule, "gamepad", "Qt5Gamepad", nullptr },
+        { QtGuiModule, "gui", "Qt5Gui", "qtbase" },
+        { QtHelpModule, "qthelp", "Qt5Help", "qt_help" },
+        { QtMultimediaModule, "multimedia", "Qt5Multimedia", "qtmultimedia" },
+        { QtMultimediaWidgetsModule, "multimediawidgets", "Qt5MultimediaWidgets", "qtmultimedia" },
+        { QtMultimediaQuickModule, "multimediaquick", "Qt5MultimediaQuick_p", "qtmultimedia" },
+        { QtNetworkModule, "network", "Qt5Network", "qtbase" },
+        { QtNfcModule, "nfc", "Qt5Nfc", nullptr },
+        { QtOpenGLModule, "opengl", "Qt5OpenGL", nullptr },
+        { QtPositioningModule, "positioning", "Qt5Positioning", nullptr },
+        { QtPrintSupportModule, "printsupport", "Qt5PrintSupport", nullptr },
+        { QtQmlModule, "qml", "Qt5Qml", "qtdeclarative" },
+        { QtQmlToolingModule, "qmltooling", "qmltooling", nullptr },
+        { QtQuickModule, "quick", "Qt5Quick", "qtdeclarative" },
+        { QtQuickParticlesModule, "quickparticles", "Qt5QuickParticles", nullptr },
+        { QtQuickWidgetsModule, "quickwidgets", "Qt5QuickWidgets", nullptr },
+        { QtScriptModule, "script", "Qt5Script", "qtscript" },
+        { QtScriptToolsModule, "scripttools", "Qt5ScriptTools", "qtscript" },
+        { QtSensorsModule, "sensors", "Qt5Sensors", nullptr },
+        { QtSerialPortModule, "serialport", "Qt5SerialPort", "qtserialport" },
+        { QtSqlModule, "sql", "Qt5Sql", "qtbase" },
+        { QtSvgModule, "svg", "Qt5Svg", nullptr },
+        { QtTestModule, "test", "Qt5Test", "qtbase" },
+        { QtWebKitModule, "webkit", "Qt5WebKit", nullptr },
+        { QtWebKitWidgetsModule, "webkitwidgets", "Qt5WebKitWidgets", nullptr },
+        { QtWebSocketsModule, "websockets", "Qt5WebSockets", nullptr },
+        { QtWidgetsModule, "widgets", "Qt5Widgets", "qtbase" },
+        { QtWinExtrasModule, "winextras", "Qt5WinExtras", nullptr },
+        { QtXmlModule, "xml", "Qt5Xml", "qtbase" },
+        { QtXmlPatternsModule, "xmlpatterns", "Qt5XmlPatterns", "qtxmlpatterns" },
+        { QtWebEngineCoreModule, "webenginecore", "Qt5WebEngineCore", nullptr },
+        { QtWebEngineModule, "webengine", "Qt5WebEngine", "qtwebengine" },
+        { QtWebEngineWidgetsModule, "webenginewidgets", "Qt5WebEngineWidgets", nullptr },
+        { Qt3DCoreModule, "3dcore", "Qt53DCore", nullptr },
+        { Qt3DRendererModule, "3drenderer", "Qt53DRender", nullptr },
+        { Qt3DQuickModule, "3dquick", "Qt53DQuick", nullptr },
+        { Qt3DQuickRendererModule, "3dquickrenderer", "Qt53DQuickRender", nullptr },
+        { Qt3DInputModule, "3dinput", "Qt53DInput", nullptr },
+        { Qt3DAnimationModule, "3danimation", "Qt53DAnimation", nullptr },
+        { Qt3DExtrasModule, "3dextras", "Qt53DExtras", nullptr },
+        { QtLocationModule, "geoservices", "Qt5Location", nullptr },
+        { QtWebChannelModule, "webchannel", "Qt5WebChannel", nullptr },
+        { QtTextToSpeechModule, "texttospeech", "Qt5TextToSpeech", nullptr },
+        { QtSerialBusModule, "serialbus", "Qt5SerialBus", nullptr },
+        { QtWebViewModule, "webview", "Qt5WebView", nullptr }
+    };
 
-    static QtModuleEntry qtModuleEntries[];
     static const DeployConfig * _config;
 
     static MSVCVersion getMSVC(const QString & _qtBin);
@@ -173,8 +231,23 @@ public:
     static bool isExecutable(const QFileInfo &file);
     static bool isContainsArraySeparators(const QString& val,
                                           int lastLvl = 2);
+
+    /**
+     * @brief findProcess - find the executable in the dirs of the env.
+     *  Checks only the expected names of the executable in each dir (proc and proc.exe, proc.bat, proc.cmd on windows),
+     *  found executables are remembered until the clearProcessCache call.
+     * @param env - list of the dirs separated by the env separator (PATH).
+     * @param proc - name of the executable without suffix.
+     * @return absolute path to the executable or empty string.
+     */
     static QString findProcess(const QString& env, const QString& proc);
 
+    /**
+     * @brief clearProcessCache - drop the executables found by the findProcess method.
+     *  Called on the start of each deploy, because the dirs of the env can be changed between deploys.
+     */
+    static void clearProcessCache();
+
 
 };
 
@@ -0,0 +1,347 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "deploymanifest.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+#include <quasarapp.h>
+
+// layout of the manifest:
+// header: magic, version, count of entries, offset and length of the fingerprint,
+//         offset and length of the fingerprint dirs ('\n' separated),
+//         offset and length of the target dir, reserved.
+// entries: offset and length of the path, size, modification time, hash of the source.
+// strings: utf8 strings, the offsets of the strings are relative to the begin of this block.
+#define MANIFEST_MAGIC "CQDM"
+#define MANIFEST_VERSION 2u
+#define MANIFEST_HEADER_SIZE 40
+#define MANIFEST_ENTRY_SIZE 32
+
+namespace {
+
+template<typename T>
+void appendValue(QByteArray &data, T value) {
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+quint32 appendString(QByteArray &strings, const QByteArray &string) {
+    auto offset = static_cast<quint32>(strings.size());
+    strings.append(string);
+    return offset;
+}
+}
+
+DeployManifest::~DeployManifest() {
+    close();
+}
+
+QString DeployManifest::location(const QString &targetDir) {
+    auto key = QCryptographicHash::hash(QFileInfo(targetDir).absoluteFilePath().toUtf8(),
+                                        QCryptographicHash::Sha1).toHex();
+
+    return manifestsDir() + "/" + QString::fromLatin1(key);
+}
+
+QString DeployManifest::manifestsDir() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/manifests";
+}
+
+bool DeployManifest::remove(const QString &targetDir) {
+    if (targetDir.isEmpty()) {
+        return false;
+    }
+
+    auto path = location(targetDir);
+    return !QFile::exists(path) || QFile::remove(path);
+}
+
+int DeployManifest::removeOutdated() {
+    int count = 0;
+
+    for (const auto &path : QDir(manifestsDir()).entryList(QDir::Files | QDir::Hidden)) {
+        auto file = manifestsDir() + "/" + path;
+
+        DeployManifest manifest;
+        bool outdated = !manifest.openFile(file) || !QFileInfo(manifest.targetDir()).isDir();
+        manifest.close();
+
+        // the manifests of the old versions do not contain the target dir, so they are removed too.
+        if (outdated && QFile::remove(file)) {
+            count++;
+        }
+    }
+
+    if (count) {
+        QuasarAppUtils::Params::log("Removed " + QString::number(count) + " manifests of the removed target dirs",
+                                    QuasarAppUtils::Info);
+    }
+
+    return count;
+}
+
+bool DeployManifest::open(const QString &targetDir) {
+    if (targetDir.isEmpty()) {
+        close();
+        return false;
+    }
+
+    return openFile(location(targetDir));
+}
+
+bool DeployManifest::openFile(const QString &path) {
+    close();
+
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _size = _file.size();
+    if (_size < MANIFEST_HEADER_SIZE) {
+        close();
+        return false;
+    }
+
+    _data = _file.map(0, _size);
+    if (!_data || memcmp(_data, MANIFEST_MAGIC, 4) || readUInt32(4) != MANIFEST_VERSION) {
+        QuasarAppUtils::Params::log("The deploy manifest " + _file.fileName() + " is invalid, ignore it.",
+                                    QuasarAppUtils::Warning);
+        close();
+        return false;
+    }
+
+    _count = readUInt32(8);
+    _stringsOffset = MANIFEST_HEADER_SIZE + static_cast<qint64>(_count) * MANIFEST_ENTRY_SIZE;
+
+    if (_stringsOffset > _size) {
+        QuasarAppUtils::Params::log("The deploy manifest " + _file.fileName() + " is truncated, ignore it.",
+                                    QuasarAppUtils::Warning);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void DeployManifest::close() {
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+
+    _file.close();
+    _data = nullptr;
+    _size = 0;
+    _count = 0;
+    _stringsOffset = 0;
+}
+
+bool DeployManifest::isOpen() const {
+    return _data;
+}
+
+QStringList DeployManifest::paths() const {
+    QStringList result;
+    result.reserve(static_cast<int>(_count));
+
+    for (quint32 i = 0; i < _count; ++i) {
+        auto path = entryPath(i);
+        if (path.size()) {
+            result.push_back(QString::fromUtf8(path));
+        }
+    }
+
+    return result;
+}
+
+bool DeployManifest::find(const QString &path, ManifestEntry &entry) const {
+    if (!_data) {
+        return false;
+    }
+
+    auto key = path.toUtf8();
+
+    quint32 begin = 0;
+    quint32 end = _count;
+    while (begin < end) {
+        auto middle = begin + (end - begin) / 2;
+        auto middlePath = entryPath(middle);
+
+        if (middlePath < key) {
+            begin = middle + 1;
+        } else if (key < middlePath) {
+            end = middle;
+        } else {
+            return readEntry(middle, entry);
+        }
+    }
+
+    return false;
+}
+
+QByteArray DeployManifest::fingerprint() const {
+    if (!_data) {
+        return {};
+    }
+
+    // copy the data, because the manifest can be closed before the using of the result.
+    auto data = string(readUInt32(12), readUInt32(16));
+    return QByteArray(data.constData(), data.size());
+}
+
+QString DeployManifest::targetDir() const {
+    if (!_data) {
+        return {};
+    }
+
+    return QString::fromUtf8(string(readUInt32(28), readUInt32(32)));
+}
+
+QStringList DeployManifest::fingerprintDirs() const {
+    if (!_data) {
+        return {};
+    }
+
+    auto dirs = QString::fromUtf8(string(readUInt32(20), readUInt32(24)));
+    if (dirs.isEmpty()) {
+        return {};
+    }
+
+    return dirs.split('\n');
+}
+
+bool DeployManifest::save(const QString &targetDir,
+                          const QList<ManifestEntry> &entries,
+                          const QByteArray &fingerprint,
+                          const QStringList &fingerprintDirs) {
+
+    if (targetDir.isEmpty()) {
+        return false;
+    }
+
+    auto path = location(targetDir);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        QuasarAppUtils::Params::log("Failed to create the dir of the deploy manifest " + path,
+                                    QuasarAppUtils::Warning);
+        return false;
+    }
+
+    QVector<QPair<QByteArray, const ManifestEntry*>> sorted;
+    sorted.reserve(entries.size());
+    for (const auto &entry: entries) {
+        sorted.push_back({entry.path.toUtf8(), &entry});
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<QByteArray, const ManifestEntry*>& left,
+                                               const QPair<QByteArray, const ManifestEntry*>& right) {
+        return left.first < right.first;
+    });
+
+    QByteArray strings;
+    QByteArray records;
+    records.reserve(sorted.size() * MANIFEST_ENTRY_SIZE);
+
+    for (const auto &item: sorted) {
+        appendValue(records, appendString(strings, item.first));
+        appendValue(records, static_cast<quint32>(item.first.size()));
+        appendValue(records, item.second->size);
+        appendValue(records, item.second->modified);
+        appendValue(records, item.second->sourceHash);
+    }
+
+    auto dirs = fingerprintDirs.join('\n').toUtf8();
+    auto target = QFileInfo(targetDir).absoluteFilePath().toUtf8();
+
+    QByteArray header(MANIFEST_MAGIC);
+    appendValue(header, MANIFEST_VERSION);
+    appendValue(header, static_cast<quint32>(sorted.size()));
+    appendValue(header, appendString(strings, fingerprint));
+    appendValue(header, static_cast<quint32>(fingerprint.size()));
+    appendValue(header, appendString(strings, dirs));
+    appendValue(header, static_cast<quint32>(dirs.size()));
+    appendValue(header, appendString(strings, target));
+    appendValue(header, static_cast<quint32>(target.size()));
+    appendValue(header, quint32(0));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(header) != header.size() ||
+            file.write(records) != records.size() ||
+            file.write(strings) != strings.size() ||
+            !file.commit()) {
+
+        QuasarAppUtils::Params::log("Failed to save the deploy manifest " + path + ": " + file.errorString(),
+                                    QuasarAppUtils::Warning);
+        return false;
+    }
+
+    return true;
+}
+
+quint64 DeployManifest::sourceHash(const QString &source, qint64 size, qint64 modified,
+                                   const QByteArray &salt) {
+    auto data = source.toUtf8();
+    appendValue(data, size);
+    appendValue(data, modified);
+    data.append(salt);
+
+    auto hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    quint64 result = 0;
+    memcpy(&result, hash.constData(), sizeof(result));
+
+    // 0 is reserved for the files without source.
+    return (result)? result: 1;
+}
+
+QByteArray DeployManifest::string(quint32 offset, quint32 length) const {
+    if (_stringsOffset + offset + length > _size) {
+        return {};
+    }
+
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(_data + _stringsOffset + offset),
+                                   static_cast<int>(length));
+}
+
+bool DeployManifest::readEntry(quint32 index, ManifestEntry &entry) const {
+    qint64 offset = MANIFEST_HEADER_SIZE + static_cast<qint64>(index) * MANIFEST_ENTRY_SIZE;
+
+    auto path = entryPath(index);
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    entry.path = QString::fromUtf8(path);
+    entry.size = readInt64(offset + 8);
+    entry.modified = readInt64(offset + 16);
+    entry.sourceHash = static_cast<quint64>(readInt64(offset + 24));
+
+    return true;
+}
+
+QByteArray DeployManifest::entryPath(quint32 index) const {
+    qint64 offset = MANIFEST_HEADER_SIZE + static_cast<qint64>(index) * MANIFEST_ENTRY_SIZE;
+    return string(readUInt32(offset), readUInt32(offset + 4));
+}
+
+quint32 DeployManifest::readUInt32(qint64 offset) const {
+    quint32 result = 0;
+    memcpy(&result, _data + offset, sizeof(result));
+    return result;
+}
+
+qint64 DeployManifest::readInt64(qint64 offset) const {
+    qint64 result = 0;
+    memcpy(&result, _data + offset, sizeof(result));
+    return result;
+}
@@ -0,0 +1,132 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DEPLOYMANIFEST_H
+#define DEPLOYMANIFEST_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include "deploy_global.h"
+
+/**
+ * @brief The ManifestEntry struct - the deployed file.
+ */
+struct DEPLOYSHARED_EXPORT ManifestEntry {
+    QString path;
+    qint64 size = 0;
+
+    /**
+     * @brief modified - modification time of the deployed file (msecs since epoch).
+     */
+    qint64 modified = 0;
+
+    /**
+     * @brief sourceHash - hash of the source of the file (see DeployManifest::sourceHash).
+     *  0 if the file is not copied from the source (generated scripts, dirs).
+     */
+    quint64 sourceHash = 0;
+};
+
+/**
+ * @brief The DeployManifest class - binary list of the deployed files of the one target dir.
+ *  The manifest is saved into the AppDataLocation/manifests/<sha1 of the target dir> file
+ *  and mapped into the memory on open. Entries are sorted by path,
+ *  so the lookup of the one file does not decode the all manifest.
+ */
+class DEPLOYSHARED_EXPORT DeployManifest
+{
+public:
+    DeployManifest() = default;
+    ~DeployManifest();
+
+    /**
+     * @brief location
+     * @return path of the manifest of the target dir.
+     */
+    static QString location(const QString& targetDir);
+
+    /**
+     * @brief remove - remove the manifest of the target dir.
+     * @return true if the manifest is removed or not exists.
+     */
+    static bool remove(const QString& targetDir);
+
+    /**
+     * @brief removeOutdated - remove the manifests of the removed target dirs and the invalid manifests.
+     * @return count of the removed manifests.
+     */
+    static int removeOutdated();
+
+    /**
+     * @brief open - map the manifest of the target dir.
+     * @return true if the manifest exists and valid.
+     */
+    bool open(const QString& targetDir);
+    void close();
+    bool isOpen() const;
+
+    QStringList paths() const;
+
+    /**
+     * @brief find - find the entry of the deployed file.
+     * @param path - absolute path of the deployed file.
+     * @param entry - result.
+     * @return true if the file is found.
+     */
+    bool find(const QString& path, ManifestEntry& entry) const;
+
+    QByteArray fingerprint() const;
+    QStringList fingerprintDirs() const;
+
+    /**
+     * @brief targetDir
+     * @return absolute path of the target dir of the opened manifest.
+     */
+    QString targetDir() const;
+
+    /**
+     * @brief save - write the manifest of the target dir. The opened manifests of the dir must be closed before.
+     * @param targetDir
+     * @param entries - deployed files.
+     * @param fingerprint - fingerprint of the deploy (see Fingerprint).
+     * @param fingerprintDirs - installation dirs used for the fingerprint.
+     * @return true if the manifest saved successful.
+     */
+    static bool save(const QString& targetDir,
+                     const QList<ManifestEntry>& entries,
+                     const QByteArray& fingerprint = {},
+                     const QStringList& fingerprintDirs = {});
+
+    /**
+     * @brief sourceHash
+     * @param salt - the data that changes the result of the copy (for example the options of the deploy).
+     * @return hash of the path, size and modification time of the source file, never 0.
+     */
+    static quint64 sourceHash(const QString& source, qint64 size, qint64 modified,
+                              const QByteArray& salt = {});
+
+private:
+    QFile _file;
+    const uchar *_data = nullptr;
+    qint64 _size = 0;
+
+    quint32 _count = 0;
+    qint64 _stringsOffset = 0;
+
+    static QString manifestsDir();
+
+    bool openFile(const QString& path);
+    QByteArray string(quint32 offset, quint32 length) const;
+    bool readEntry(quint32 index, ManifestEntry &entry) const;
+    QByteArray entryPath(quint32 index) const;
+    quint32 readUInt32(qint64 offset) const;
+    qint64 readInt64(qint64 offset) const;
+};
+
+#endif // DEPLOYMANIFEST_H
@@ -0,0 +1,179 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "batchdeploy.h"
+#include "deploy.h"
+#include "deploycore.h"
+#include "deployserver.h"
+#include "dependenciesscanner.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <quasarapp.h>
+
+DeployServer::DeployServer(QObject *parent): QObject(parent) {
+    _server = new QLocalServer(this);
+    _scaner = new DependenciesScanner();
+    _appPath = QuasarAppUtils::Params::getStrArg("appPath");
+
+    auto targetDirs = QuasarAppUtils::Params::getStrArg("targetDir").
+            split(DeployCore::getSeparator(0), QString::SkipEmptyParts);
+
+    if (targetDirs.isEmpty()) {
+        targetDirs.push_back(QDir::currentPath());
+    }
+
+    for (const auto &dir : targetDirs) {
+        _allowedTargetDirs.push_back(QFileInfo(dir).absoluteFilePath());
+    }
+
+    connect(_server, &QLocalServer::newConnection,
+            this, &DeployServer::handleNewConnection);
+}
+
+DeployServer::~DeployServer() {
+    delete _scaner;
+}
+
+bool DeployServer::listen(const QString &name) {
+
+    // remove the socket file of the previous crashed server.
+    QLocalServer::removeServer(name);
+
+    // only the owner of the server can send the requests.
+    _server->setSocketOptions(QLocalServer::UserAccessOption);
+
+    if (!_server->listen(name)) {
+        QuasarAppUtils::Params::log("Failed to start deploy server: " + _server->errorString(),
+                                    QuasarAppUtils::Error);
+        return false;
+    }
+
+    QuasarAppUtils::Params::log("Deploy server started on " + _server->fullServerName(),
+                                QuasarAppUtils::Info);
+
+    return true;
+}
+
+int DeployServer::submit(const QString &name, const QStringList &args) {
+    QLocalSocket socket;
+    socket.connectToServer(name);
+
+    if (!socket.waitForConnected(1000)) {
+        QuasarAppUtils::Params::log("Failed to connect to deploy server " + name +
+                                    ": " + socket.errorString(),
+                                    QuasarAppUtils::Error);
+        return PrepareError;
+    }
+
+    QByteArray request;
+    QDataStream stream(&request, QIODevice::WriteOnly);
+    stream << QDir::currentPath() << args;
+
+    socket.write(request);
+
+    if (!socket.waitForBytesWritten(-1)) {
+        return PrepareError;
+    }
+
+    QDataStream answer(&socket);
+    qint32 code = PrepareError;
+
+    while (socket.state() == QLocalSocket::ConnectedState || socket.bytesAvailable()) {
+        answer.startTransaction();
+        answer >> code;
+
+        if (answer.commitTransaction()) {
+            return code;
+        }
+
+        if (!socket.waitForReadyRead(-1)) {
+            break;
+        }
+    }
+
+    QuasarAppUtils::Params::log("The deploy server closed the connection without result",
+                                QuasarAppUtils::Error);
+    return DeployError;
+}
+
+int DeployServer::runRequest(const QString &workDir, const QStringList &args) {
+    auto serverDir = QDir::currentPath();
+
+    if (!QDir::setCurrent(workDir)) {
+        QuasarAppUtils::Params::log("Working dir of the request not exits: " + workDir,
+                                    QuasarAppUtils::Error);
+        return PrepareError;
+    }
+
+    int code = PrepareError;
+
+    if (QuasarAppUtils::Params::parseParams(args)) {
+
+        if (QuasarAppUtils::Params::getStrArg("appPath").isEmpty()) {
+            QuasarAppUtils::Params::setArg("appPath", _appPath);
+        }
+
+        _scaner->clearOutdated();
+
+        if (BatchDeploy::isBatch()) {
+            BatchDeploy batch(_scaner);
+            batch.setAllowedTargetDirs(_allowedTargetDirs);
+            code = batch.run(args);
+        } else {
+            Deploy deploy(_scaner);
+            deploy.setAllowedTargetDirs(_allowedTargetDirs);
+            code = deploy.run();
+        }
+    }
+
+    QDir::setCurrent(serverDir);
+
+    return code;
+}
+
+void DeployServer::handleNewConnection() {
+    while (auto socket = _server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead,
+                this, &DeployServer::handleReadyRead);
+        connect(socket, &QLocalSocket::disconnected,
+                socket, &QLocalSocket::deleteLater);
+    }
+}
+
+void DeployServer::handleReadyRead() {
+    auto socket = qobject_cast<QLocalSocket*>(sender());
+
+    if (!socket) {
+        return;
+    }
+
+    QString workDir;
+    QStringList args;
+
+    QDataStream stream(socket);
+    stream.startTransaction();
+    stream >> workDir >> args;
+
+    if (!stream.commitTransaction()) {
+        // wait for the rest of the request
+        return;
+    }
+
+    QuasarAppUtils::Params::log("New deploy request: " + args.join(' '),
+                                QuasarAppUtils::Info);
+
+    qint32 code = runRequest(workDir, args);
+
+    QDataStream answer(socket);
+    answer << code;
+    socket->flush();
+    socket->disconnectFromServer();
+}
@@ -0,0 +1,69 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DEPLOYSERVER_H
+#define DEPLOYSERVER_H
+
+#include <QObject>
+#include <QStringList>
+#include "deploy_global.h"
+
+class QLocalServer;
+class QLocalSocket;
+class DependenciesScanner;
+
+#define DEFAULT_SERVER_NAME QString("cqtdeployer")
+
+/**
+ * @brief The DeployServer class - resident deploy process.
+ * The server keeps the dependencies scaner (cache of scaned libraries and the envirement index)
+ * and the qmake query results between deploys. The clients send the deploy parameters
+ * over the local socket (unix domain socket on linux) and receive the exit code of the deploy.
+ */
+class DEPLOYSHARED_EXPORT DeployServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeployServer(QObject *parent = nullptr);
+    ~DeployServer() override;
+
+    /**
+     * @brief listen - start listening the local socket.
+     * @param name - name of the local socket.
+     * @return true if the server started successful.
+     */
+    bool listen(const QString& name = DEFAULT_SERVER_NAME);
+
+    /**
+     * @brief submit - send the deploy request to the running server and wait for the result.
+     * @param name - name of the local socket of the server.
+     * @param args - parameters of the deploy (same as the cqtdeployer arguments).
+     * @return exit code of the deploy.
+     */
+    static int submit(const QString& name, const QStringList& args);
+
+private:
+    QLocalServer *_server = nullptr;
+    DependenciesScanner *_scaner = nullptr;
+    QString _appPath;
+
+    /**
+     * @brief _allowedTargetDirs - the requests can deploy only into these dirs.
+     *  The targetDir option of the server or the working dir of the server.
+     */
+    QStringList _allowedTargetDirs;
+
+    int runRequest(const QString& workDir, const QStringList& args);
+
+private slots:
+    void handleNewConnection();
+    void handleReadyRead();
+
+    friend class deploytest;
+};
+
+#endif // DEPLOYSERVER_H
@@ -0,0 +1,111 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "deploywatcher.h"
+#include "extracter.h"
+#include "filemanager.h"
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <quasarapp.h>
+
+#define WATCH_DEBOUNCE_INTERVAL 500
+
+DeployWatcher::DeployWatcher(Extracter *extracter, FileManager *fileManager,
+                             const QString &targetDir, QObject *parent):
+    QObject(parent) {
+
+    _extracter = extracter;
+    _fileManager = fileManager;
+    _targetDir = targetDir;
+
+    _watcher = new QFileSystemWatcher(this);
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    _timer->setInterval(WATCH_DEBOUNCE_INTERVAL);
+
+    connect(_watcher, &QFileSystemWatcher::fileChanged,
+            this, &DeployWatcher::handleChanged);
+    connect(_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &DeployWatcher::handleChanged);
+    connect(_timer, &QTimer::timeout,
+            this, &DeployWatcher::handleTimeout);
+}
+
+bool DeployWatcher::start() {
+    updateWatchList();
+
+    auto count = _watcher->files().size() + _watcher->directories().size();
+    if (!count) {
+        QuasarAppUtils::Params::log("Nothing to watch", QuasarAppUtils::Error);
+        return false;
+    }
+
+    QuasarAppUtils::Params::log("Watch " + QString::number(count) + " sources of the deployment",
+                                QuasarAppUtils::Info);
+
+    return true;
+}
+
+void DeployWatcher::updateWatchList() {
+    auto watched = _watcher->files() + _watcher->directories();
+    QStringList newPaths;
+
+    for (const auto &path : _extracter->watchPaths()) {
+        // the compilers and linkers replace files, so the removed file need to be added again.
+        if (!watched.contains(path) && QFileInfo::exists(path)) {
+            newPaths.push_back(path);
+        }
+    }
+
+    if (newPaths.size()) {
+        _watcher->addPaths(newPaths);
+    }
+}
+
+void DeployWatcher::handleChanged(const QString &path) {
+    _changed.insert(QFileInfo(path).absoluteFilePath());
+    _timer->start();
+}
+
+void DeployWatcher::handleTimeout() {
+    auto changed = _changed;
+    _changed.clear();
+
+    for (auto it = changed.begin(); it != changed.end();) {
+        QFileInfo info(*it);
+
+        if (info.exists()) {
+            _retries.remove(*it);
+            ++it;
+            continue;
+        }
+
+        // the file is being rewritten, wait for the next change.
+        if (QFileInfo::exists(info.absolutePath()) && ++_retries[*it] <= WATCH_MAX_RETRIES) {
+            _changed.insert(*it);
+        } else {
+            QuasarAppUtils::Params::log("The watched path " + *it + " is removed, it will not be redeployed",
+                                        QuasarAppUtils::Warning);
+            _retries.remove(*it);
+        }
+
+        it = changed.erase(it);
+    }
+
+    if (changed.size()) {
+        _extracter->redeploy(changed);
+        _fileManager->saveDeploymendFiles(_targetDir);
+    }
+
+    updateWatchList();
+
+    if (_changed.size()) {
+        _timer->start();
+    }
+}
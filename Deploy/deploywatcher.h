@@ -0,0 +1,64 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DEPLOYWATCHER_H
+#define DEPLOYWATCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include "deploy_global.h"
+
+#define WATCH_MAX_RETRIES 10
+
+class QFileSystemWatcher;
+class QTimer;
+class Extracter;
+class FileManager;
+
+/**
+ * @brief The DeployWatcher class - watch the sources of the deployment and run incremental redeploy after changes.
+ * The changes are collected during the debounce interval, so one rebuild of the project calls only one redeploy.
+ */
+class DEPLOYSHARED_EXPORT DeployWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeployWatcher(Extracter *extracter, FileManager *fileManager,
+                           const QString& targetDir, QObject *parent = nullptr);
+
+    /**
+     * @brief start - start watching the sources of the last deploy.
+     * @return true if at least one path is watched.
+     */
+    bool start();
+
+private:
+    QFileSystemWatcher *_watcher = nullptr;
+    QTimer *_timer = nullptr;
+    Extracter *_extracter = nullptr;
+    FileManager *_fileManager = nullptr;
+    QString _targetDir;
+    QSet<QString> _changed;
+
+    /**
+     * @brief _retries - count of the checks of the changed paths that do not exist.
+     *  The removed paths are dropped after the WATCH_MAX_RETRIES checks.
+     */
+    QHash<QString, int> _retries;
+
+    void updateWatchList();
+
+private slots:
+    void handleChanged(const QString& path);
+    void handleTimeout();
+
+    friend class deploytest;
+};
+
+#endif // DEPLOYWATCHER_H
@@ -0,0 +1,237 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "dirwalker.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+bool DirEntry::isDir() const {
+    return type == Dir;
+}
+
+bool DirEntry::isFile() const {
+    return type == File;
+}
+
+QString DirEntry::fileName() const {
+    return path.mid(path.lastIndexOf('/') + 1);
+}
+
+QString DirEntry::dirPath() const {
+    return path.left(path.lastIndexOf('/'));
+}
+
+QString DirEntry::relativePath() const {
+    return path.mid(rootLength + 1);
+}
+
+QList<DirEntry> DirWalker::walk(const QString &root, int filters, int maxDepth) {
+    QList<DirEntry> result;
+
+    if (root.isEmpty()) {
+        return result;
+    }
+
+    Context context;
+    context.filters = filters;
+    context.maxDepth = maxDepth;
+
+    auto rootPath = QDir::cleanPath(QDir::fromNativeSeparators(QFileInfo(root).absoluteFilePath()));
+    if (rootPath == "/") {
+        // the entries of the root of the file system are "/name"
+        rootPath.clear();
+    }
+    context.rootLength = rootPath.size();
+
+    QStringList subDirs;
+    listDir(rootPath, 0, context, result, subDirs);
+
+    if ((filters & Parallel) && subDirs.size() > 1) {
+        struct Task {
+            QString dir;
+            QList<DirEntry> entries;
+        };
+
+        QVector<Task> tasks;
+        tasks.reserve(subDirs.size());
+        for (const auto &dir : subDirs) {
+            tasks.push_back({dir, {}});
+        }
+
+        QtConcurrent::blockingMap(tasks, [&context](Task& task) {
+            walkDir(task.dir, 1, context, task.entries);
+        });
+
+        for (const auto &task : tasks) {
+            result += task.entries;
+        }
+    } else {
+        for (const auto &dir : subDirs) {
+            walkDir(dir, 1, context, result);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const DirEntry& left, const DirEntry& right) {
+        return left.path < right.path;
+    });
+
+    return result;
+}
+
+QStringList DirWalker::paths(const QString &root, int filters, int maxDepth) {
+    QStringList result;
+
+    const auto entries = walk(root, filters, maxDepth);
+    result.reserve(entries.size());
+
+    for (const auto &entry : entries) {
+        result.push_back(entry.path);
+    }
+
+    return result;
+}
+
+void DirWalker::walkDir(const QString &dir, int depth, const Context &context, QList<DirEntry> &result) {
+    QStringList subDirs;
+    listDir(dir, depth, context, result, subDirs);
+
+    for (const auto &subDir : subDirs) {
+        walkDir(subDir, depth + 1, context, result);
+    }
+}
+
+bool DirWalker::isLoop(const QString &dir, const QString &link) {
+    auto target = QFileInfo(link).canonicalFilePath();
+    auto current = QFileInfo(dir).canonicalFilePath();
+
+    return target.isEmpty() || current == target || current.startsWith(target + "/");
+}
+
+#ifdef Q_OS_UNIX
+
+void DirWalker::listDir(const QString &dir, int depth, const Context &context,
+                        QList<DirEntry> &result, QStringList &subDirs) {
+
+    DIR *handle = opendir(QFile::encodeName(dir.isEmpty()? "/" : dir).constData());
+    if (!handle) {
+        return;
+    }
+
+    bool recursive = context.maxDepth < 0 || depth < context.maxDepth;
+
+    while (auto item = readdir(handle)) {
+        const char *name = item->d_name;
+
+        if (name[0] == '.') {
+            if (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')) {
+                continue;
+            }
+
+            if (!(context.filters & Hidden)) {
+                continue;
+            }
+        }
+
+        unsigned char type = item->d_type;
+        bool isLink = type == DT_LNK;
+
+        if (type == DT_UNKNOWN) {
+            struct stat info;
+            if (fstatat(dirfd(handle), name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            isLink = S_ISLNK(info.st_mode);
+            type = S_ISDIR(info.st_mode)? DT_DIR : S_ISREG(info.st_mode)? DT_REG : DT_UNKNOWN;
+        }
+
+        if (isLink) {
+            struct stat info;
+
+            // broken symlinks are skipped as the QDir does.
+            if (fstatat(dirfd(handle), name, &info, 0) != 0) {
+                continue;
+            }
+
+            type = S_ISDIR(info.st_mode)? DT_DIR : S_ISREG(info.st_mode)? DT_REG : DT_UNKNOWN;
+        }
+
+        if (type != DT_DIR && type != DT_REG) {
+            continue;
+        }
+
+        DirEntry entry;
+        entry.path = dir + "/" + QFile::decodeName(name);
+        entry.type = (type == DT_DIR)? DirEntry::Dir : DirEntry::File;
+        entry.depth = depth;
+        entry.rootLength = context.rootLength;
+
+        if (entry.isDir() && recursive &&
+                (!isLink || ((context.filters & FollowSymlinks) && !isLoop(dir, entry.path)))) {
+            subDirs.push_back(entry.path);
+        }
+
+        if ((entry.isDir() && (context.filters & Dirs)) ||
+                (entry.isFile() && (context.filters & Files))) {
+            result.push_back(entry);
+        }
+    }
+
+    closedir(handle);
+}
+
+#else
+
+void DirWalker::listDir(const QString &dir, int depth, const Context &context,
+                        QList<DirEntry> &result, QStringList &subDirs) {
+
+    QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    if (context.filters & Hidden) {
+        filters |= QDir::Hidden;
+    }
+
+    bool recursive = context.maxDepth < 0 || depth < context.maxDepth;
+
+    QDirIterator it(dir, filters);
+    while (it.hasNext()) {
+        it.next();
+        auto info = it.fileInfo();
+
+        if (!info.isDir() && !info.isFile()) {
+            continue;
+        }
+
+        DirEntry entry;
+        entry.path = dir + "/" + info.fileName();
+        entry.type = info.isDir()? DirEntry::Dir : DirEntry::File;
+        entry.depth = depth;
+        entry.rootLength = context.rootLength;
+
+        if (entry.isDir() && recursive &&
+                (!info.isSymLink() || ((context.filters & FollowSymlinks) && !isLoop(dir, entry.path)))) {
+            subDirs.push_back(entry.path);
+        }
+
+        if ((entry.isDir() && (context.filters & Dirs)) ||
+                (entry.isFile() && (context.filters & Files))) {
+            result.push_back(entry);
+        }
+    }
+}
+
+#endif
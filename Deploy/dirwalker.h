@@ -0,0 +1,111 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DIRWALKER_H
+#define DIRWALKER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "deploy_global.h"
+
+/**
+ * @brief The DirEntry struct - entry of the dir found by the DirWalker.
+ */
+struct DEPLOYSHARED_EXPORT DirEntry {
+    enum Type : quint8 {
+        File,
+        Dir
+    };
+
+    /**
+     * @brief path - absolute path of the entry with the '/' separators.
+     */
+    QString path;
+    Type type = File;
+
+    /**
+     * @brief depth - 0 for the entries of the root dir.
+     */
+    int depth = 0;
+
+    /**
+     * @brief rootLength - length of the root dir path, used by the relativePath method.
+     */
+    int rootLength = 0;
+
+    bool isDir() const;
+    bool isFile() const;
+    QString fileName() const;
+
+    /**
+     * @brief dirPath
+     * @return absolute path of the dir that contains this entry.
+     */
+    QString dirPath() const;
+
+    /**
+     * @brief relativePath
+     * @return path of the entry relative to the root dir of the walk.
+     */
+    QString relativePath() const;
+};
+
+/**
+ * @brief The DirWalker class - fast recursive listing of the dirs.
+ *  On unix uses the readdir with the d_type of the entries, the stat is called only for the symlinks
+ *  and for the file systems that do not provide the d_type. Hidden entries are skipped by default (as the QDir does).
+ */
+class DEPLOYSHARED_EXPORT DirWalker
+{
+public:
+    enum Filter {
+        Files = 0x01,
+        Dirs = 0x02,
+        AllEntries = Files | Dirs,
+        Hidden = 0x04,
+        /// follow the symlinks to the dirs (loops of the symlinks are skipped).
+        FollowSymlinks = 0x08,
+        /// walk the subdirs of the root dir in the parallel.
+        Parallel = 0x10
+    };
+
+    /**
+     * @brief walk - list all entries of the dir recursively.
+     * @param root - root dir of the walk. Not included into the result.
+     * @param filters - combination of the Filter flags.
+     * @param maxDepth - max depth of the walk. 0 - only entries of the root dir, -1 - unlimited.
+     * @return list of the entries sorted by path.
+     */
+    static QList<DirEntry> walk(const QString& root, int filters, int maxDepth = -1);
+
+    /**
+     * @brief paths - same as walk, but returns only paths of the entries.
+     */
+    static QStringList paths(const QString& root, int filters, int maxDepth = -1);
+
+private:
+
+    struct Context {
+        int filters = 0;
+        int maxDepth = -1;
+        int rootLength = 0;
+    };
+
+    static void walkDir(const QString& dir, int depth, const Context& context, QList<DirEntry>& result);
+
+    /**
+     * @brief listDir - list the entries of the one dir.
+     * @param subDirs - the dirs for the next step of the walk.
+     */
+    static void listDir(const QString& dir, int depth, const Context& context,
+                        QList<DirEntry>& result, QStringList& subDirs);
+
+    static bool isLoop(const QString& dir, const QString& link);
+};
+
+#endif // DIRWALKER_H
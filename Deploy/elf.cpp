@@ -6,8 +6,12 @@
 //#
 
 #include "elf.h"
+#include "statcache.h"
 #include <cmath>
+#include <cstring>
+#include <QFile>
 #include <QFileInfo>
+#include <QtEndian>
 #include <quasarapp.h>
 
 ELF::ELF()
@@ -50,6 +54,352 @@ int ELF::getVersionOfTag(const QByteArray& tag, QByteArray& source) const {
     return ver;
 }
 
+template <typename T>
+static T readElfValue(const uchar *data, bool littleEndian) {
+    return (littleEndian)? qFromLittleEndian<T>(data): qFromBigEndian<T>(data);
+}
+
+bool ELF::getSymbols(const QString &lib,
+                     QSet<QByteArray> &undefinedSymbols,
+                     QSet<QByteArray> &definedSymbols) const {
+
+    ElfReader reader(lib);
+    auto headers = reader.readHeaders();
+
+    if (headers.elfclass != ElfClass::Elf_ELFCLASS32 &&
+            headers.elfclass != ElfClass::Elf_ELFCLASS64) {
+        return false;
+    }
+
+    bool is64 = headers.elfclass == ElfClass::Elf_ELFCLASS64;
+    bool littleEndian = headers.endian == ElfEndian::Elf_ELFDATA2LSB;
+
+    auto symbols = reader.readSection(".dynsym");
+    auto strings = reader.readSection(".dynstr");
+
+    if (symbols.isEmpty() || strings.isEmpty()) {
+        return false;
+    }
+
+    // Elf32_Sym: name(4) value(4) size(4) info(1) other(1) shndx(2)
+    // Elf64_Sym: name(4) info(1) other(1) shndx(2) value(8) size(8)
+    const int entrySize = (is64)? 24 : 16;
+    const int infoOffset = (is64)? 4 : 12;
+    const int sectionOffset = (is64)? 6 : 14;
+
+    auto data = reinterpret_cast<const uchar*>(symbols.constData());
+
+    // first entry of the table is always the null symbol.
+    for (int offset = entrySize; offset + entrySize <= symbols.size(); offset += entrySize) {
+        auto entry = data + offset;
+
+        auto nameOffset = readElfValue<quint32>(entry, littleEndian);
+        auto binding = entry[infoOffset] >> 4;
+        auto section = readElfValue<quint16>(entry + sectionOffset, littleEndian);
+
+        // only the global (1) and weak (2) symbols are visible for other objects.
+        if ((binding != 1 && binding != 2) || nameOffset >= static_cast<quint32>(strings.size())) {
+            continue;
+        }
+
+        auto name = strings.constData() + nameOffset;
+        auto nameSize = qstrnlen(name, static_cast<uint>(strings.size()) - nameOffset);
+
+        if (!nameSize) {
+            continue;
+        }
+
+        if (section) {
+            definedSymbols.insert(QByteArray(name, static_cast<int>(nameSize)));
+        } else {
+            undefinedSymbols.insert(QByteArray(name, static_cast<int>(nameSize)));
+        }
+    }
+
+    return true;
+}
+
+bool ELF::findRunPath(const uchar *dynamic, quint64 size, bool is64, bool littleEndian,
+                      quint64 &stringOffset) const {
+
+    // Elf32_Dyn: tag(4) value(4), Elf64_Dyn: tag(8) value(8)
+    const quint64 entrySize = (is64)? 16 : 8;
+    const quint64 dtNull = 0;
+    const quint64 dtRPath = 15;
+    const quint64 dtRunPath = 29;
+
+    bool found = false;
+
+    for (quint64 offset = 0; offset + entrySize <= size; offset += entrySize) {
+        auto entry = dynamic + offset;
+
+        quint64 tag = (is64)? readElfValue<quint64>(entry, littleEndian):
+                              readElfValue<quint32>(entry, littleEndian);
+
+        if (tag == dtNull) {
+            break;
+        }
+
+        quint64 value = (is64)? readElfValue<quint64>(entry + 8, littleEndian):
+                                readElfValue<quint32>(entry + 4, littleEndian);
+
+        // DT_RUNPATH overrides DT_RPATH
+        if (tag == dtRunPath || (tag == dtRPath && !found)) {
+            stringOffset = value;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+QStringList ELF::getRunPath(const QString &file) const {
+    ElfReader reader(file);
+    auto headers = reader.readHeaders();
+
+    if (headers.elfclass != ElfClass::Elf_ELFCLASS32 &&
+            headers.elfclass != ElfClass::Elf_ELFCLASS64) {
+        return {};
+    }
+
+    auto dynamic = reader.readSection(".dynamic");
+    auto dynStr = reader.readSection(".dynstr");
+
+    quint64 stringOffset = 0;
+    if (!findRunPath(reinterpret_cast<const uchar*>(dynamic.constData()),
+                     static_cast<quint64>(dynamic.size()),
+                     headers.elfclass == ElfClass::Elf_ELFCLASS64,
+                     headers.endian == ElfEndian::Elf_ELFDATA2LSB,
+                     stringOffset)) {
+        return {};
+    }
+
+    if (stringOffset >= static_cast<quint64>(dynStr.size())) {
+        return {};
+    }
+
+    auto begin = dynStr.constData() + stringOffset;
+    auto runPath = QString::fromUtf8(begin, static_cast<int>(
+                                         qstrnlen(begin, static_cast<uint>(dynStr.size() - static_cast<int>(stringOffset)))));
+    return runPath.split(':', QString::SkipEmptyParts);
+}
+
+QByteArray ELF::getBuildId(const QString &file) const {
+    ElfReader reader(file);
+    auto headers = reader.readHeaders();
+
+    if (headers.elfclass != ElfClass::Elf_ELFCLASS32 &&
+            headers.elfclass != ElfClass::Elf_ELFCLASS64) {
+        return {};
+    }
+
+    bool littleEndian = headers.endian == ElfEndian::Elf_ELFDATA2LSB;
+    auto note = reader.readSection(".note.gnu.build-id");
+
+    // note: namesz(4) descsz(4) type(4) name (aligned to 4) desc
+    if (note.size() < 12) {
+        return {};
+    }
+
+    auto data = reinterpret_cast<const uchar*>(note.constData());
+    auto nameSize = readElfValue<quint32>(data, littleEndian);
+    auto descSize = readElfValue<quint32>(data + 4, littleEndian);
+    quint64 descOffset = 12 + ((static_cast<quint64>(nameSize) + 3) & ~quint64(3));
+
+    if (!descSize || descOffset + descSize > static_cast<quint64>(note.size())) {
+        return {};
+    }
+
+    return note.mid(static_cast<int>(descOffset), static_cast<int>(descSize)).toHex();
+}
+
+bool ELF::setRunPath(const QString &file, const QByteArray &runPath) const {
+    ElfReader reader(file);
+    auto headers = reader.readHeaders();
+
+    if (headers.elfclass != ElfClass::Elf_ELFCLASS32 &&
+            headers.elfclass != ElfClass::Elf_ELFCLASS64) {
+        return false;
+    }
+
+    bool is64 = headers.elfclass == ElfClass::Elf_ELFCLASS64;
+    bool littleEndian = headers.endian == ElfEndian::Elf_ELFDATA2LSB;
+
+    const ElfSectionHeader *dynamic = nullptr;
+    const ElfSectionHeader *dynStr = nullptr;
+
+    for (const auto &sectionHeader : headers.sectionHeaders) {
+        if (sectionHeader.name == ".dynamic") {
+            dynamic = &sectionHeader;
+        } else if (sectionHeader.name == ".dynstr") {
+            dynStr = &sectionHeader;
+        }
+    }
+
+    if (!dynamic || !dynStr) {
+        return false;
+    }
+
+    QFile elfFile(file);
+    if (!elfFile.open(QIODevice::ReadWrite)) {
+        QuasarAppUtils::Params::log("Failed to open " + file + " for patch the run path",
+                                    QuasarAppUtils::Warning);
+        return false;
+    }
+
+    auto fileSize = static_cast<quint64>(elfFile.size());
+    if (dynamic->offset + dynamic->size > fileSize || dynStr->offset + dynStr->size > fileSize) {
+        return false;
+    }
+
+    auto data = elfFile.map(0, elfFile.size());
+    if (!data) {
+        return false;
+    }
+
+    quint64 stringOffset = 0;
+    bool found = findRunPath(data + dynamic->offset, dynamic->size, is64, littleEndian, stringOffset);
+
+    bool result = false;
+
+    if (!found) {
+        QuasarAppUtils::Params::log(file + " does not have the run path entry, the run path is not changed",
+                                    QuasarAppUtils::Info);
+    } else if (stringOffset < dynStr->size) {
+        auto oldRunPath = reinterpret_cast<char*>(data + dynStr->offset + stringOffset);
+        auto oldSize = qstrnlen(oldRunPath, static_cast<uint>(dynStr->size - stringOffset));
+
+        if (static_cast<uint>(runPath.size()) > oldSize) {
+            QuasarAppUtils::Params::log("The new run path of " + file + " is longer than the existing (" +
+                                        QString::fromLatin1(oldRunPath, static_cast<int>(oldSize)) +
+                                        "), the run path is not changed",
+                                        QuasarAppUtils::Warning);
+        } else {
+            memset(oldRunPath, 0, oldSize);
+            memcpy(oldRunPath, runPath.constData(), static_cast<size_t>(runPath.size()));
+            result = true;
+        }
+    }
+
+    elfFile.unmap(data);
+    elfFile.close();
+
+    if (result) {
+        StatCache::invalidate(file);
+    }
+
+    return result;
+}
+
+int ELF::removeNeeded(const QString &file, const QSet<QByteArray> &libs) const {
+    ElfReader reader(file);
+    auto headers = reader.readHeaders();
+
+    if (libs.isEmpty() ||
+            (headers.elfclass != ElfClass::Elf_ELFCLASS32 &&
+             headers.elfclass != ElfClass::Elf_ELFCLASS64)) {
+        return 0;
+    }
+
+    bool is64 = headers.elfclass == ElfClass::Elf_ELFCLASS64;
+    bool littleEndian = headers.endian == ElfEndian::Elf_ELFDATA2LSB;
+
+    const ElfSectionHeader *dynamic = nullptr;
+    const ElfSectionHeader *dynStr = nullptr;
+
+    for (const auto &sectionHeader : headers.sectionHeaders) {
+        if (sectionHeader.name == ".dynamic") {
+            dynamic = &sectionHeader;
+        } else if (sectionHeader.name == ".dynstr") {
+            dynStr = &sectionHeader;
+        }
+    }
+
+    if (!dynamic || !dynStr) {
+        return 0;
+    }
+
+    QFile elfFile(file);
+    if (!elfFile.open(QIODevice::ReadWrite)) {
+        QuasarAppUtils::Params::log("Failed to open " + file + " for remove the needed libraries",
+                                    QuasarAppUtils::Warning);
+        return 0;
+    }
+
+    auto fileSize = static_cast<quint64>(elfFile.size());
+    if (dynamic->offset + dynamic->size > fileSize || dynStr->offset + dynStr->size > fileSize) {
+        return 0;
+    }
+
+    auto data = elfFile.map(0, elfFile.size());
+    if (!data) {
+        return 0;
+    }
+
+    // Elf32_Dyn: tag(4) value(4), Elf64_Dyn: tag(8) value(8)
+    const quint64 entrySize = (is64)? 16 : 8;
+    const quint64 dtNull = 0;
+    const quint64 dtNeeded = 1;
+
+    // the scaner keeps the names of the dependencies in the upper case.
+    QSet<QByteArray> names;
+    for (const auto &lib : libs) {
+        names.insert(lib.toUpper());
+    }
+
+    auto begin = data + dynamic->offset;
+    quint64 writeOffset = 0;
+    quint64 offset = 0;
+    int removed = 0;
+
+    // the kept entries are moved to the begin of the section (as the patchelf --remove-needed does),
+    // the freed tail is filled by the DT_NULL entries.
+    for (; offset + entrySize <= dynamic->size; offset += entrySize) {
+        auto entry = begin + offset;
+
+        quint64 tag = (is64)? readElfValue<quint64>(entry, littleEndian):
+                              readElfValue<quint32>(entry, littleEndian);
+
+        if (tag == dtNull) {
+            break;
+        }
+
+        if (tag == dtNeeded) {
+            quint64 value = (is64)? readElfValue<quint64>(entry + 8, littleEndian):
+                                    readElfValue<quint32>(entry + 4, littleEndian);
+
+            if (value < dynStr->size) {
+                auto name = reinterpret_cast<const char*>(data + dynStr->offset + value);
+                auto nameSize = qstrnlen(name, static_cast<uint>(dynStr->size - value));
+
+                if (names.contains(QByteArray(name, static_cast<int>(nameSize)).toUpper())) {
+                    removed++;
+                    continue;
+                }
+            }
+        }
+
+        if (writeOffset != offset) {
+            memmove(begin + writeOffset, entry, entrySize);
+        }
+
+        writeOffset += entrySize;
+    }
+
+    if (removed) {
+        memset(begin + writeOffset, 0, offset - writeOffset);
+    }
+
+    elfFile.unmap(data);
+    elfFile.close();
+
+    if (removed) {
+        StatCache::invalidate(file);
+    }
+
+    return removed;
+}
+
 bool ELF::getLibInfo(const QString &lib, LibInfo &info) const {
     ElfReader reader(lib);
 
@@ -73,7 +423,8 @@ bool ELF::getLibInfo(const QString &lib, LibInfo &info) const {
                 break;
             }
 
-            if (QFileInfo(*i).isDir()) {
+            // the most of the strings are names of the symbols, only the paths are checked.
+            if (i->contains('/') && StatCache::isDir(*i)) {
                 info.setQtPath(*i);
             }
 
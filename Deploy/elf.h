@@ -17,12 +17,63 @@ class ELF : public IGetLibInfo
 private:
     QByteArrayList getDynamicString(ElfReader &reader) const;
 
+    /**
+     * @brief findRunPath - find the offset of the run path string in the string table.
+     * @param dynamic - data of the .dynamic section.
+     * @param size - size of the .dynamic section.
+     * @param stringOffset - offset of the run path in the .dynstr section.
+     * @return true if the DT_RUNPATH or DT_RPATH entry found.
+     */
+    bool findRunPath(const uchar *dynamic, quint64 size, bool is64, bool littleEndian,
+                     quint64 &stringOffset) const;
+
     int getVersionOfTag(const QByteArray &tag, QByteArray &source) const;
 
 public:
     ELF();
 
     bool getLibInfo(const QString &lib, LibInfo &info) const override;
+
+    /**
+     * @brief getSymbols - read the global and weak symbols of the dynamic symbol table (.dynsym).
+     * @param lib - path to the elf file.
+     * @param undefinedSymbols - symbols that the file imports.
+     * @param definedSymbols - symbols that the file exports.
+     * @return true if the dynamic symbol table was read.
+     */
+    bool getSymbols(const QString &lib, QSet<QByteArray> &undefinedSymbols,
+                    QSet<QByteArray> &definedSymbols) const;
+
+    /**
+     * @brief setRunPath - rewrite the DT_RUNPATH (or DT_RPATH) string of the elf file in place.
+     * The new value must not be longer than the existing string, because the string table can not be resized.
+     * @param file - path to the elf file.
+     * @param runPath - new value of the run path.
+     * @return true if the run path was rewritten.
+     */
+    bool setRunPath(const QString &file, const QByteArray &runPath) const;
+
+    /**
+     * @brief getRunPath
+     * @param file - path to the elf file.
+     * @return list of the paths of the DT_RUNPATH (or DT_RPATH) entry. $ORIGIN is not expanded.
+     */
+    QStringList getRunPath(const QString &file) const;
+
+    /**
+     * @brief removeNeeded - remove the DT_NEEDED entries of the libraries from the .dynamic section of the elf file in place.
+     * @param file - path to the elf file.
+     * @param libs - names of the libraries, the names are compared case insensitive.
+     * @return count of the removed entries.
+     */
+    int removeNeeded(const QString &file, const QSet<QByteArray> &libs) const;
+
+    /**
+     * @brief getBuildId
+     * @param file - path to the elf file.
+     * @return hex string of the build id (.note.gnu.build-id) or empty string if the file does not have it.
+     */
+    QByteArray getBuildId(const QString &file) const;
 };
 
 #endif // ELF_H
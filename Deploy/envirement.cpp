@@ -6,8 +6,10 @@
 //#
 
 #include "deploycore.h"
+#include "dirwalker.h"
 #include "envirement.h"
 #include "pathutils.h"
+#include "statcache.h"
 #include "quasarapp.h"
 
 #include <QDir>
@@ -84,10 +86,8 @@ void Envirement::addEnv(const QStringList &listDirs) {
 }
 
 bool Envirement::inThisEnvirement(const QString &file) const {
-    QFileInfo info (file);
-
-    if (info.isFile()) {
-        return _dataEnvironment.contains(PathUtils::fixPath(info.absolutePath()));
+    if (StatCache::isFile(file)) {
+        return _dataEnvironment.contains(PathUtils::fixPath(QFileInfo(file).absolutePath()));
     }
 
     return _dataEnvironment.contains(PathUtils::fixPath(file));
@@ -118,17 +118,12 @@ QStringList Envirement::recursiveInvairement(QDir &dir, int depch, int depchLimi
         return {dir.absolutePath()};
     }
 
-    QFileInfoList list = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
-    QStringList res = {};
+    // the entries of the dir have the depth 0 in the walker.
+    int walkDepth = (depchLimit < 0)? -1 : depchLimit - depch - 1;
 
-    for (QFileInfo &i : list) {
-        if (!dir.cd(i.fileName())) {
-            continue;
-        }
-        res += Envirement::recursiveInvairement(dir, depch + 1, depchLimit);
-
-        dir.cdUp();
-    }
+    QStringList res = DirWalker::paths(dir.absolutePath(),
+                                       DirWalker::Dirs | DirWalker::FollowSymlinks | DirWalker::Parallel,
+                                       walkDepth);
 
     res += dir.absolutePath();
 
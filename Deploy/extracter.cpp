@@ -6,18 +6,21 @@
  */
 
 #include "extracter.h"
+#include "binarysniffer.h"
 #include "deploycore.h"
+#include "dirwalker.h"
 #include "pluginsparser.h"
 #include "configparser.h"
 #include "metafilemanager.h"
 #include "pathutils.h"
+#include "statcache.h"
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
-#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
+#include <QtConcurrent>
 #include <QRegularExpression>
 #include <quasarapp.h>
 #include <cstdio>
@@ -136,15 +139,40 @@ void Extracter::copyPlugins(const QStringList &list, const QString& package) {
     copyExtraPlugins(package);
 }
 
+void Extracter::forEachPackage(const std::function<void (const QString &)> &func) {
+    auto cnf = DeployCore::_config;
+    auto packages = cnf->packages().keys();
+
+    // create the items in the main thread, the tasks must not change the structure of the hashes.
+    for (const auto &package : packages) {
+        _packageDependencyes[package];
+        _pluginsDependencyes[package];
+
+        for (const auto &target : cnf->packages().value(package).targets()) {
+            _targetsDependencyes[target];
+        }
+    }
+
+    QtConcurrent::blockingMap(packages, [&func](const QString &package) {
+        func(package);
+    });
+}
+
 void Extracter::extractAllTargets() {
     auto cfg = DeployCore::_config;
-    for (auto i = cfg->packages().cbegin(); i != cfg->packages().cend(); ++i) {
-        _packageDependencyes[i.key()] = {};
 
-        for (const auto &target : i.value().targets()) {
-            extract(target, &_packageDependencyes[i.key()]);
+    forEachPackage([this, cfg](const QString &package) {
+        auto &packageDeps = _packageDependencyes[package];
+        packageDeps = {};
+
+        for (const auto &target : cfg->packages().value(package).targets()) {
+            auto &targetDeps = _targetsDependencyes[target];
+            targetDeps = {};
+
+            extract(target, &targetDeps);
+            packageDeps += targetDeps;
         }
-    }
+    });
 }
 
 void Extracter::clear() {
@@ -159,15 +187,14 @@ void Extracter::clear() {
 
 void Extracter::extractPlugins() {
     auto cnf = DeployCore::_config;
-    PluginsParser pluginsParser;
 
-    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
-        auto distro = cnf->getDistroFromPackage(i.key());
+    forEachPackage([this, cnf](const QString &package) {
+        PluginsParser pluginsParser;
 
         QStringList plugins;
-        pluginsParser.scan(cnf->qtDir.getPlugins(), plugins, _packageDependencyes[i.key()].qtModules());
-        copyPlugins(plugins, i.key());
-    }
+        pluginsParser.scan(cnf->qtDir.getPlugins(), plugins, _packageDependencyes[package].qtModules());
+        copyPlugins(plugins, package);
+    });
 }
 
 void Extracter::copyLibs(const QSet<QString> &files, const QString& package) {
@@ -185,17 +212,17 @@ void Extracter::copyLibs(const QSet<QString> &files, const QString& package) {
 void Extracter::copyFiles() {
     auto cnf = DeployCore::_config;
 
-    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
-
-        copyLibs(_packageDependencyes[i.key()].neadedLibs(), i.key());
+    forEachPackage([this](const QString &package) {
+        copyLibs(_packageDependencyes[package].neadedLibs(), package);
 
         if (QuasarAppUtils::Params::isEndable("deploySystem")) {
-            copyLibs(_packageDependencyes[i.key()].systemLibs(), i.key());
+            copyLibs(_packageDependencyes[package].systemLibs(), package);
         }
+    });
 
-        if (!QuasarAppUtils::Params::isEndable("noStrip") && !_fileManager->strip(cnf->getTargetDir())) {
-            QuasarAppUtils::Params::log("strip failed!");
-        }
+    // the target dir contains all packages, so strip all of them at once.
+    if (!QuasarAppUtils::Params::isEndable("noStrip") && !_fileManager->strip(cnf->getTargetDir())) {
+        QuasarAppUtils::Params::log("strip failed!");
     }
 }
 
@@ -203,15 +230,13 @@ void Extracter::copyTr() {
 
     if (!QuasarAppUtils::Params::isEndable("noTranslations")) {
 
-        auto cnf = DeployCore::_config;
-
-        for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
-            if (!copyTranslations(DeployCore::extractTranslation(_packageDependencyes[i.key()].neadedLibs()),
-                                  i.key())) {
+        forEachPackage([this](const QString &package) {
+            if (!copyTranslations(DeployCore::extractTranslation(_packageDependencyes[package].neadedLibs()),
+                                  package)) {
                 QuasarAppUtils::Params::log("Failed to copy standard Qt translations",
                                                    QuasarAppUtils::Warning);
             }
-        }
+        });
 
     }
 }
@@ -229,8 +254,16 @@ void Extracter::deploy() {
                                            QuasarAppUtils::Error);
     }
 
+    if (DeployCore::_config->deployQml && QuasarAppUtils::Params::isEndable("qmlCacheGen")) {
+        compileQml();
+    }
+
     extractPlugins();
 
+    if (QuasarAppUtils::Params::isEndable("pruneUnusedLibs")) {
+        printPruneReport();
+    }
+
     copyFiles();
 
     copyTr();
@@ -243,6 +276,14 @@ void Extracter::deploy() {
         QuasarAppUtils::Params::log("deploy msvc failed");
     }
 
+    if (QuasarAppUtils::Params::isEndable("pruneUnusedLibs")) {
+        removePrunedNeeded();
+    }
+
+    if (QuasarAppUtils::Params::isEndable("patchRunPath")) {
+        patchRunPaths();
+    }
+
     _metaFileManager->createRunMetaFiles();
     QuasarAppUtils::Params::log("deploy done!",
                                        QuasarAppUtils::Info);
@@ -287,17 +328,9 @@ QFileInfoList Extracter::findFilesInsideDir(const QString &name,
                                          const QString &dirpath) {
     QFileInfoList files;
 
-    QDir dir(dirpath);
-
-    auto list = dir.entryInfoList( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-
-    for (const auto & item :list) {
-        if (item.isFile()) {
-            if (item.fileName().contains(name)) {
-                files += item;
-            }
-        } else {
-            files += findFilesInsideDir(name, item.absoluteFilePath());
+    for (const auto &item : DirWalker::walk(dirpath, DirWalker::Files | DirWalker::FollowSymlinks)) {
+        if (item.fileName().contains(name)) {
+            files += QFileInfo(item.path);
         }
     }
 
@@ -324,7 +357,8 @@ void Extracter::extractLib(const QString &file,
             continue;
         }
 
-        if (line.getPriority() < LibPriority::SystemLib && !depMap->containsNeadedLib(line.fullPath())) {
+        if (line.getPriority() < LibPriority::SystemLib) {
+            // addNeadedLib skips the already added libraries itself.
             depMap->addNeadedLib(line.fullPath());
 
         } else if (QuasarAppUtils::Params::isEndable("deploySystem") &&
@@ -337,11 +371,399 @@ void Extracter::extractLib(const QString &file,
 }
 
 void Extracter::extractPluginLib(const QString& item, const QString& package) {
+    DependencyMap pluginDeps;
+
     if (QuasarAppUtils::Params::isEndable("extractPlugins")) {
-        extract(item, &_packageDependencyes[package]);
+        extract(item, &pluginDeps);
     } else {
-        extract(item, &_packageDependencyes[package], "Qt");
+        extract(item, &pluginDeps, "Qt");
+    }
+
+    _pluginsDependencyes[package] += pluginDeps;
+    _packageDependencyes[package] += pluginDeps;
+}
+
+void Extracter::printPruneReport() const {
+    qint64 savedSize = 0;
+    int count = 0;
+
+    const auto &pruned = _scaner->prunedLibs();
+    for (auto it = pruned.cbegin(); it != pruned.cend(); ++it) {
+        bool deployed = false;
+
+        for (const auto &deps : _packageDependencyes) {
+            if (deps.containsNeadedLib(it.key()) || deps.containsSysLib(it.key())) {
+                deployed = true;
+                break;
+            }
+        }
+
+        if (!deployed) {
+            QuasarAppUtils::Params::log("Unused library skipped: " + it.key(),
+                                        QuasarAppUtils::Info);
+            savedSize += it.value();
+            count++;
+        }
+    }
+
+    QuasarAppUtils::Params::log("pruneUnusedLibs: skipped " + QString::number(count) +
+                                " libraries, saved " + QString::number(savedSize / 1024) + " KiB",
+                                QuasarAppUtils::Info);
+}
+
+void Extracter::removePrunedNeeded() {
+    const auto prunedNeeded = _scaner->prunedNeeded();
+    if (prunedNeeded.isEmpty()) {
+        return;
+    }
+
+    // the deployed files have the names of the sources.
+    QHash<QString, QSet<QString>> prunedByName;
+    for (auto it = prunedNeeded.cbegin(); it != prunedNeeded.cend(); ++it) {
+        prunedByName[QFileInfo(it.key()).fileName()] += it.value();
+    }
+
+    const auto deployedFiles = _fileManager->getDeployedFiles();
+
+    QSet<QString> deployedNames;
+    for (const auto &file : deployedFiles) {
+        deployedNames.insert(QFileInfo(file).fileName().toUpper());
+    }
+
+    ELF elf;
+    int count = 0;
+
+    for (const auto &file : deployedFiles) {
+        auto pruned = prunedByName.constFind(QFileInfo(file).fileName());
+        if (pruned == prunedByName.cend()) {
+            continue;
+        }
+
+        // the library deployed for the other binaries can stay in the DT_NEEDED.
+        QSet<QByteArray> libs;
+        for (const auto &lib : *pruned) {
+            if (!deployedNames.contains(lib.toUpper())) {
+                libs.insert(lib.toUtf8());
+            }
+        }
+
+        if (int removed = elf.removeNeeded(file, libs)) {
+            QuasarAppUtils::Params::log("Removed " + QString::number(removed) +
+                                        " needed libraries from " + file,
+                                        QuasarAppUtils::Debug);
+            count += removed;
+        }
+    }
+
+    QuasarAppUtils::Params::log("pruneUnusedLibs: removed " + QString::number(count) +
+                                " needed entries of the pruned libraries",
+                                QuasarAppUtils::Info);
+}
+
+void Extracter::patchRunPaths() {
+    auto cnf = DeployCore::_config;
+    ELF elf;
+    int count = 0;
+
+    for (const auto &file : _fileManager->getDeployedFiles()) {
+        QFileInfo info(file);
+
+        if (!info.isFile() || !(DeployCore::isLib(info) || DeployCore::isExecutable(info))) {
+            continue;
+        }
+
+        // find the package of the file, the default package contains all other packages.
+        QString package;
+        int prefixSize = -1;
+
+        for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+            auto packagePath = QDir(cnf->getTargetDir() + "/" + i.key()).absolutePath() + "/";
+
+            if (info.absoluteFilePath().startsWith(packagePath) && packagePath.size() > prefixSize) {
+                package = i.key();
+                prefixSize = packagePath.size();
+            }
+        }
+
+        if (prefixSize < 0) {
+            continue;
+        }
+
+        auto libDir = cnf->getTargetDir() + "/" + package +
+                cnf->getDistroFromPackage(package).getLibOutDir();
+        auto relative = QDir(info.absolutePath()).relativeFilePath(libDir);
+
+        QByteArray runPath = "$ORIGIN";
+        if (!relative.isEmpty() && relative != ".") {
+            runPath += "/" + relative.toUtf8();
+        }
+
+        if (elf.setRunPath(info.absoluteFilePath(), runPath)) {
+            QuasarAppUtils::Params::log("Set run path of " + info.absoluteFilePath() + " to " + runPath,
+                                        QuasarAppUtils::Debug);
+            count++;
+        }
+    }
+
+    QuasarAppUtils::Params::log("The run path changed for " + QString::number(count) + " files",
+                                QuasarAppUtils::Info);
+}
+
+void Extracter::compileQml() {
+    auto cnf = DeployCore::_config;
+
+    QString qmlcachegen = cnf->qtDir.getBins() + "/qmlcachegen";
+    if (!QFileInfo::exists(qmlcachegen) && QFileInfo::exists(qmlcachegen + ".exe")) {
+        qmlcachegen += ".exe";
+    }
+
+    if (!QFileInfo::exists(qmlcachegen)) {
+        QuasarAppUtils::Params::log("qmlcachegen not found in " + cnf->qtDir.getBins() +
+                                    ", the qml cache is not created",
+                                    QuasarAppUtils::Warning);
+        return;
+    }
+
+    QStringList sources;
+
+    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+        auto qmlDir = cnf->getTargetDir() + "/" + i.key() +
+                cnf->getDistroFromPackage(i.key()).getQmlOutDir();
+
+        if (!QFileInfo(qmlDir).isDir()) {
+            continue;
+        }
+
+        for (const auto &file : DirWalker::walk(qmlDir, DirWalker::Files | DirWalker::Parallel)) {
+            auto name = file.fileName();
+
+            if (name.endsWith(".qml", ONLY_WIN_CASE_INSENSIATIVE) ||
+                    name.endsWith(".js", ONLY_WIN_CASE_INSENSIATIVE)) {
+                sources.push_back(file.path);
+            }
+        }
+    }
+
+    // the cache is created near the source (name.qml -> name.qmlc), so the qml engine finds it.
+    QList<QPair<QString, bool>> tasks;
+    for (const auto &source : sources) {
+        tasks.push_back({source, false});
+    }
+
+    QtConcurrent::blockingMap(tasks, [&qmlcachegen](QPair<QString, bool>& task) {
+        QProcess P;
+        P.setProgram(qmlcachegen);
+        P.setArguments({"-o", task.first + "c", task.first});
+        P.start();
+
+        task.second = P.waitForStarted() && P.waitForFinished() && P.exitCode() == 0;
+    });
+
+    int count = 0;
+    for (const auto &task : tasks) {
+        if (task.second) {
+            _fileManager->addToDeployed(task.first + "c");
+            count++;
+        } else {
+            QuasarAppUtils::Params::log("Failed to create the qml cache for " + task.first,
+                                        QuasarAppUtils::Warning);
+        }
+    }
+
+    QuasarAppUtils::Params::log(QString("The qml cache created for %0 of %1 files").
+                                arg(count).arg(tasks.size()),
+                                QuasarAppUtils::Info);
+}
+
+void Extracter::removeLibs(const QSet<QString> &files, const QString &package) {
+    auto cnf = DeployCore::_config;
+    auto targetPath = cnf->getTargetDir() + "/" + package;
+    auto distro = cnf->getDistroFromPackage(package);
+
+    for (const auto &file : files) {
+        QFileInfo deployed(targetPath + distro.getLibOutDir() + QFileInfo(file).fileName());
+
+        if (!deployed.exists()) {
+            continue;
+        }
+
+        if (_fileManager->removeFile(deployed)) {
+            _fileManager->removeFromDeployed(deployed.absoluteFilePath());
+            QuasarAppUtils::Params::log("Remove " + deployed.absoluteFilePath() + " because it is not used",
+                                        QuasarAppUtils::Info);
+        }
+    }
+}
+
+void Extracter::updatePackage(const QString &package,
+                              const DependencyMap &oldDeps,
+                              const DependencyMap &newDeps) {
+
+    DependencyMap added = newDeps;
+    added -= oldDeps;
+
+    DependencyMap removed = oldDeps;
+    removed -= newDeps;
+
+    copyLibs(added.neadedLibs(), package);
+    removeLibs(removed.neadedLibs(), package);
+
+    if (QuasarAppUtils::Params::isEndable("deploySystem")) {
+        copyLibs(added.systemLibs(), package);
+        removeLibs(removed.systemLibs(), package);
+    }
+
+    _packageDependencyes[package] = newDeps;
+
+    if (added.qtModules()) {
+        QuasarAppUtils::Params::log("New qt modules found, deploy plugins of package " + package,
+                                    QuasarAppUtils::Info);
+
+        auto pluginsDeps = _pluginsDependencyes.value(package);
+
+        QStringList plugins;
+        PluginsParser pluginsParser;
+        pluginsParser.scan(DeployCore::_config->qtDir.getPlugins(), plugins, added.qtModules());
+        copyPlugins(plugins, package);
+
+        DependencyMap pluginsAdded = _pluginsDependencyes.value(package);
+        pluginsAdded -= pluginsDeps;
+        pluginsAdded -= newDeps;
+
+        copyLibs(pluginsAdded.neadedLibs(), package);
+    }
+}
+
+void Extracter::redeploy(const QSet<QString> &changed) {
+    QuasarAppUtils::Params::log("redeploy started!",
+                                QuasarAppUtils::Info);
+
+    auto cnf = DeployCore::_config;
+    auto oldDeps = _packageDependencyes;
+
+    // the sources are changed after the previous deploy.
+    StatCache::clear();
+
+    // the files of the previous deploy are already stripped.
+    _fileManager->markDeployedAsUnchanged();
+
+    _scaner->setEnvironment(cnf->envirement.environmentList());
+    _scaner->clearScaned(changed);
+
+    bool dirsChanged = false;
+    bool qmlChanged = false;
+
+    for (const auto &path : changed) {
+        dirsChanged = dirsChanged || QFileInfo(path).isDir();
+
+        for (auto i = cnf->packages().cbegin(); !qmlChanged && i != cnf->packages().cend(); ++i) {
+            for (const auto &qmlInput : i.value().qmlInput()) {
+                if (path.startsWith(QFileInfo(qmlInput).absoluteFilePath())) {
+                    qmlChanged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (qmlChanged && cnf->deployQml && !extractQml()) {
+        QuasarAppUtils::Params::log("qml not extacted!",
+                                    QuasarAppUtils::Error);
+    }
+
+    if (qmlChanged && cnf->deployQml && QuasarAppUtils::Params::isEndable("qmlCacheGen")) {
+        compileQml();
+    }
+
+    const auto &sources = _cqt->movedTargets();
+
+    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+        DependencyMap newDeps = _pluginsDependencyes.value(i.key());
+
+        for (const auto &target : i.value().targets()) {
+            auto source = sources.value(target);
+            bool targetChanged = changed.contains(source);
+
+            if (targetChanged && !_fileManager->copyFile(source, QFileInfo(target).absolutePath())) {
+                QuasarAppUtils::Params::log("Failed to copy changed target " + source,
+                                            QuasarAppUtils::Error);
+            }
+
+            auto &targetDeps = _targetsDependencyes[target];
+
+            bool libsChanged = false;
+            for (const auto &lib : changed) {
+                if (targetDeps.containsNeadedLib(lib) || targetDeps.containsSysLib(lib)) {
+                    libsChanged = true;
+                    break;
+                }
+            }
+
+            if (targetChanged || libsChanged || dirsChanged) {
+                targetDeps = {};
+                extract(target, &targetDeps);
+            }
+
+            newDeps += targetDeps;
+        }
+
+        updatePackage(i.key(), oldDeps.value(i.key()), newDeps);
+
+        for (const auto &lib : changed) {
+            if (newDeps.containsNeadedLib(lib) || newDeps.containsSysLib(lib)) {
+                copyLibs({lib}, i.key());
+            }
+        }
+    }
+
+    // the copied files are processed like in the full deploy.
+    if (!QuasarAppUtils::Params::isEndable("noStrip") && !_fileManager->strip(cnf->getTargetDir())) {
+        QuasarAppUtils::Params::log("strip failed!");
+    }
+
+    if (QuasarAppUtils::Params::isEndable("pruneUnusedLibs")) {
+        removePrunedNeeded();
+    }
+
+    if (QuasarAppUtils::Params::isEndable("patchRunPath")) {
+        patchRunPaths();
+    }
+
+    _metaFileManager->createRunMetaFiles();
+
+    QuasarAppUtils::Params::log("redeploy done!",
+                                QuasarAppUtils::Info);
+}
+
+QStringList Extracter::watchPaths() const {
+    auto cnf = DeployCore::_config;
+    QSet<QString> result;
+
+    for (const auto &source : _cqt->movedTargets()) {
+        result.insert(source);
+    }
+
+    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+        for (const auto &qmlInput : i.value().qmlInput()) {
+            for (const auto &dir : Envirement::recursiveInvairement(qmlInput)) {
+                result.insert(dir);
+            }
+        }
+    }
+
+    for (const auto &extraDir : cnf->extraPaths.getExtraPaths()) {
+        result.insert(extraDir);
+    }
+
+    for (const auto &deps : _packageDependencyes) {
+        for (const auto &lib : deps.neadedLibs()) {
+            if (DeployCore::getLibPriority(lib) == ExtraLib) {
+                result.insert(lib);
+            }
+        }
     }
+
+    return result.values();
 }
 
 bool Extracter::extractQmlAll() {
@@ -353,34 +775,37 @@ bool Extracter::extractQmlAll() {
         return false;
     }
 
-    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
-        auto targetPath = cnf->getTargetDir() + "/" + i.key();
-        auto distro = cnf->getDistroFromPackage(i.key());
+    QAtomicInt failed(0);
+
+    forEachPackage([this, cnf, &failed](const QString &package) {
+        auto targetPath = cnf->getTargetDir() + "/" + package;
+        auto distro = cnf->getDistroFromPackage(package);
 
         QStringList listItems;
 
         if (!_fileManager->copyFolder(cnf->qtDir.getQmls(), targetPath + distro.getQmlOutDir(),
                         QStringList() << ".so.debug" << "d.dll" << ".pdb",
                         &listItems)) {
-            return false;
+            failed.ref();
+            return;
         }
 
         for (const auto &item : listItems) {
-            extractPluginLib(item, i.key());
+            extractPluginLib(item, package);
         }
+    });
 
-    }
-
-    return true;
+    return !failed.load();
 }
 
 bool Extracter::extractQmlFromSource() {
 
     auto cnf = DeployCore::_config;
+    QAtomicInt failed(0);
 
-    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
-        auto targetPath = cnf->getTargetDir() + "/" + i.key();
-        auto distro = cnf->getDistroFromPackage(i.key());
+    forEachPackage([this, cnf, &failed](const QString &package) {
+        auto targetPath = cnf->getTargetDir() + "/" + package;
+        auto distro = cnf->getDistroFromPackage(package);
 
         QStringList plugins;
         QStringList listItems;
@@ -415,16 +840,16 @@ bool Extracter::extractQmlFromSource() {
         if (!_fileManager->copyFolder(cnf->qtDir.getQmls(),
                                      targetPath + distro.getQmlOutDir(),
                         filter , &listItems, &plugins)) {
-            return false;
+            failed.ref();
+            return;
         }
 
         for (const auto &item : listItems) {
-            extractPluginLib(item, i.key());
+            extractPluginLib(item, package);
         }
+    });
 
-    }
-
-    return true;
+    return !failed.load();
 }
 
 bool Extracter::extractQml() {
@@ -445,17 +870,10 @@ void Extracter::extract(const QString &file,
 
     assert(depMap);
 
-    QFileInfo info(file);
-
-    auto sufix = info.completeSuffix();
-
-    if (sufix.compare("dll", Qt::CaseSensitive) == 0 ||
-            sufix.compare("exe", Qt::CaseSensitive) == 0 ||
-            sufix.isEmpty() || sufix.contains("so", Qt::CaseSensitive)) {
-
+    if (BinarySniffer::sniff(file).isBinary()) {
         extractLib(file, depMap, mask);
     } else {
-        QuasarAppUtils::Params::log("file with sufix " + sufix + " not supported!");
+        QuasarAppUtils::Params::log("file " + file + " is not the binary, not supported!");
     }
 
 }
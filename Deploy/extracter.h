@@ -10,6 +10,7 @@
 #include <QDir>
 #include <QString>
 #include <QStringList>
+#include <functional>
 #include <dependenciesscanner.h>
 #include "dependencymap.h"
 #include "deploy_global.h"
@@ -24,6 +25,16 @@ class DEPLOYSHARED_EXPORT Extracter {
 
     QHash<QString, DependencyMap> _packageDependencyes;
 
+    /**
+     * @brief _targetsDependencyes - dependencies of each deployed target. key - deployed target path.
+     */
+    QHash<QString, DependencyMap> _targetsDependencyes;
+
+    /**
+     * @brief _pluginsDependencyes - dependencies of the plugins and the qml modules of each package.
+     */
+    QHash<QString, DependencyMap> _pluginsDependencyes;
+
     DependenciesScanner *_scaner;
     FileManager *_fileManager;
     ConfigParser *_cqt;
@@ -55,6 +66,15 @@ class DEPLOYSHARED_EXPORT Extracter {
      * @brief compress - this function join all target dependecies in to one struct
      */
     void compress();
+
+    /**
+     * @brief forEachPackage - run the function for all packages in the parallel.
+     *  Items of the packages in the dependencies maps are created before the start,
+     *  so each task changes only the items of own package.
+     * @param func - the function of the one package. Must be thread-safe for different packages.
+     */
+    void forEachPackage(const std::function<void(const QString& package)> &func);
+
     void extractAllTargets();
     void extractPlugins();
     void copyFiles();
@@ -65,11 +85,59 @@ class DEPLOYSHARED_EXPORT Extracter {
     bool isWebEngine(const QString& package) const;
     void extractPluginLib(const QString &item, const QString &package);
 
+    void removeLibs(const QSet<QString> &files, const QString &package);
+
+    /**
+     * @brief printPruneReport - print the libraries skipped by the pruneUnusedLibs mode
+     *  and not deployed for other reasons.
+     */
+    void printPruneReport() const;
+
+    /**
+     * @brief removePrunedNeeded - remove the DT_NEEDED entries of the pruned libraries
+     *  that are not deployed from the deployed elf files, else the dynamic loader fails to start the application.
+     */
+    void removePrunedNeeded();
+
+    /**
+     * @brief patchRunPaths - set the run path of all deployed elf files to the lib dir of the package ($ORIGIN/<relative path>).
+     */
+    void patchRunPaths();
+
+    /**
+     * @brief compileQml - create the qml disk cache (.qmlc and .jsc files) for all deployed qml and js files.
+     *  Uses the qmlcachegen of the qt and runs in the parallel.
+     */
+    void compileQml();
+
+    /**
+     * @brief updatePackage - copy to the package only the libraries that added
+     * into the new dependencies map and remove the libraries that not used anymore.
+     * @param package
+     * @param oldDeps - dependencies of the previous deploy.
+     * @param newDeps - actual dependencies.
+     */
+    void updatePackage(const QString &package, const DependencyMap &oldDeps, const DependencyMap &newDeps);
+
 public:
     explicit Extracter(FileManager *fileManager, ConfigParser * cqt, DependenciesScanner *_scaner);
     void deploy();
     void clear();
 
+    /**
+     * @brief redeploy - incremental deploy after changes of the sources.
+     * Rescans only changed targets and targets that depend on the changed libraries,
+     * then copies or removes only difference between the old and the new dependencies.
+     * @param changed - list of changed files and dirs.
+     */
+    void redeploy(const QSet<QString> &changed);
+
+    /**
+     * @brief watchPaths
+     * @return list of the sources of the deployment (targets, qml sources, extra libraries) for the watch mode.
+     */
+    QStringList watchPaths() const;
+
     friend class deploytest;
 };
 
@@ -8,26 +8,51 @@
 
 
 #include "filemanager.h"
+#include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QtConcurrent>
 #include <quasarapp.h>
 #include "configparser.h"
 #include "deploycore.h"
+#include "dirwalker.h"
+#include "elf.h"
+#include "fingerprint.h"
 #include <QProcess>
+#include <algorithm>
 #include <fstream>
 #include "pathutils.h"
+#include "statcache.h"
 
 #ifdef Q_OS_WIN
 #include "windows.h"
 #endif
 
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef RENAME_EXCHANGE
+#define RENAME_EXCHANGE (1 << 1)
+#endif
+#endif
+
 FileManager::FileManager() {
 }
 
+FileManager::~FileManager() {
+    _backgroundTasks.waitForFinished();
+}
+
 bool FileManager::initDir(const QString &path) {
 
-    if (!QFileInfo::exists(path)) {
+    if (!StatCache::exists(path)) {
         addToDeployed(path);
-        if (!QDir().mkpath(path)) {
+        bool created = QDir().mkpath(path);
+        StatCache::invalidate(path);
+
+        if (!created) {
             return false;
         }
     }
@@ -37,21 +62,30 @@ bool FileManager::initDir(const QString &path) {
 
 
 QSet<QString> FileManager::getDeployedFiles() const {
+    QMutexLocker locker(&_deployedFilesMutex);
     return _deployedFiles;
 }
 
 QStringList FileManager::getDeployedFilesStringList() const {
+    QMutexLocker locker(&_deployedFilesMutex);
     return _deployedFiles.values();
 }
 
 void FileManager::loadDeployemendFiles(const QString &targetDir) {
-    auto settings = QuasarAppUtils::Settings::get();
-
     if (targetDir.isEmpty())
         return;
 
-    QStringList deployedFiles = settings->getValue(targetDir, "").toStringList();
+    _optionsKey = Fingerprint::options();
+
+    QStringList deployedFiles;
+    if (_manifest.open(targetDir)) {
+        deployedFiles = _manifest.paths();
+    } else {
+        auto settings = QuasarAppUtils::Settings::get();
+        deployedFiles = settings->getValue(targetDir, "").toStringList();
+    }
 
+    QMutexLocker locker(&_deployedFilesMutex);
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     _deployedFiles.unite(deployedFiles.toSet());
 #else
@@ -59,14 +93,31 @@ void FileManager::loadDeployemendFiles(const QString &targetDir) {
 #endif
 }
 
+bool FileManager::isUnchangedCopy(const QString &target, quint64 sourceHash) const {
+    ManifestEntry entry;
+    if (!_manifest.find(target, entry) || entry.sourceHash != sourceHash) {
+        return false;
+    }
+
+    auto stat = StatCache::stat(target);
+    return stat.isFile && stat.size == entry.size &&
+            stat.lastModified.toMSecsSinceEpoch() == entry.modified;
+}
 
 bool FileManager::addToDeployed(const QString& path) {
+    // the path is added after the write, so the cached metadata is outdated.
+    StatCache::invalidate(path);
+
     auto info = QFileInfo(path);
-    if (info.isFile() || !info.exists()) {
+    auto stat = StatCache::stat(path);
+
+    if (stat.isFile || !stat.exists) {
+        _deployedFilesMutex.lock();
         _deployedFiles += info.absoluteFilePath();
+        _deployedFilesMutex.unlock();
 
         auto completeSufix = info.completeSuffix();
-        if (info.isFile() && (completeSufix.isEmpty() || completeSufix.toLower() == "run"
+        if (stat.isFile && (completeSufix.isEmpty() || completeSufix.toLower() == "run"
                 || completeSufix.toLower() == "sh")) {
 
             if (!QFile::setPermissions(path, static_cast<QFile::Permission>(0x7777))) {
@@ -76,7 +127,7 @@ bool FileManager::addToDeployed(const QString& path) {
 
 #ifdef Q_OS_WIN
 
-        if (info.isFile()) {
+        if (stat.isFile) {
             auto stdString = QDir::toNativeSeparators(info.absoluteFilePath()).toStdString();
 
             DWORD attribute = GetFileAttributesA(stdString.c_str());
@@ -91,13 +142,125 @@ bool FileManager::addToDeployed(const QString& path) {
 }
 
 void FileManager::removeFromDeployed(const QString &path) {
-
+    QMutexLocker locker(&_deployedFilesMutex);
     _deployedFiles -= path;
+    _deployedSources.remove(path);
+    _unchangedFiles.remove(path);
 }
 
-void FileManager::saveDeploymendFiles(const QString& targetDir) {
+void FileManager::markDeployedAsUnchanged() {
+    QMutexLocker locker(&_deployedFilesMutex);
+    _unchangedFiles.unite(_deployedFiles);
+}
+
+void FileManager::saveDeploymendFiles(const QString& targetDir,
+                                      const QByteArray &fingerprint,
+                                      const QStringList &fingerprintDirs) {
+
+    const auto deployedFiles = getDeployedFiles();
+
+    QList<ManifestEntry> entries;
+    entries.reserve(deployedFiles.size());
+
+    for (const auto &path: deployedFiles) {
+        ManifestEntry entry;
+        entry.path = path;
+
+        auto stat = StatCache::stat(path);
+        if (stat.isFile) {
+            entry.size = stat.size;
+            entry.modified = stat.lastModified.toMSecsSinceEpoch();
+
+            QMutexLocker locker(&_deployedFilesMutex);
+            entry.sourceHash = _deployedSources.value(path);
+        }
+
+        entries.push_back(entry);
+    }
+
+    // the manifest is replaced, so the mapping of the old one must be released.
+    _manifest.close();
+
+    if (!DeployManifest::save(targetDir, entries, fingerprint, fingerprintDirs)) {
+        return;
+    }
+
+    DeployManifest::removeOutdated();
+
+    // drop the lists saved by the old versions, the manifest replaces them.
     auto settings = QuasarAppUtils::Settings::get();
-    settings->setValue(targetDir, getDeployedFilesStringList());
+    if (settings->getValue(targetDir, "").toStringList().size()) {
+        settings->setValue(targetDir, QStringList{});
+        settings->setValue("fingerprint:" + targetDir, QStringList{});
+    }
+}
+
+QByteArray FileManager::loadFingerprint(const QString &targetDir, QStringList &fingerprintDirs) const {
+    DeployManifest manifest;
+
+    if (!manifest.open(targetDir)) {
+        return {};
+    }
+
+    fingerprintDirs = manifest.fingerprintDirs();
+    return manifest.fingerprint();
+}
+
+bool FileManager::runTool(const QString &tool, const QStringList &args) {
+    QProcess P;
+    P.setProgram(tool);
+    P.setArguments(args);
+    P.start();
+
+    if (!P.waitForStarted())
+        return false;
+    if (!P.waitForFinished())
+        return false;
+
+    return P.exitCode() == 0;
+}
+
+bool FileManager::stripFile(const QString &file, const QString &debugDir) {
+    QString debugFile;
+
+    if (debugDir.size()) {
+        auto buildId = ELF().getBuildId(file);
+
+        if (buildId.size() > 2) {
+            auto dir = debugDir + "/.build-id/" + buildId.left(2);
+            debugFile = dir + "/" + buildId.mid(2) + ".debug";
+
+            // the debug info of the build is already saved, the file can be already stripped.
+            if (StatCache::isFile(debugFile)) {
+                QuasarAppUtils::Params::log("Debug info of " + file + " already exists: " + debugFile,
+                                            QuasarAppUtils::Info);
+            } else if (!QDir().mkpath(dir) ||
+                    !runTool("objcopy", {"--only-keep-debug", file, debugFile})) {
+                QuasarAppUtils::Params::log("Failed to extract debug info of " + file,
+                                            QuasarAppUtils::Warning);
+                debugFile.clear();
+            } else {
+                StatCache::invalidate(debugFile);
+            }
+        } else {
+            QuasarAppUtils::Params::log(file + " does not have the build id, debug info will not be saved",
+                                        QuasarAppUtils::Warning);
+        }
+    }
+
+    bool stripped = runTool("strip", {file});
+    StatCache::invalidate(file);
+
+    if (!stripped) {
+        return false;
+    }
+
+    if (debugFile.size() && !runTool("objcopy", {"--add-gnu-debuglink=" + debugFile, file})) {
+        QuasarAppUtils::Params::log("Failed to add debuglink to " + file,
+                                    QuasarAppUtils::Warning);
+    }
+
+    return true;
 }
 
 bool FileManager::strip(const QString &dir) const {
@@ -113,35 +276,49 @@ bool FileManager::strip(const QString &dir) const {
         return false;
     }
 
-    if (info.isDir()) {
-        QDir d(dir);
-        auto list = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    QStringList files;
 
-        bool res = false;
-        for (const auto &i : list) {
-            res = strip(i.absoluteFilePath()) || res;
+    _deployedFilesMutex.lock();
+    auto unchangedFiles = _unchangedFiles;
+    _deployedFilesMutex.unlock();
+
+    auto addFile = [&files, &unchangedFiles](const QString& file) {
+        if (unchangedFiles.contains(file)) {
+            QuasarAppUtils::Params::log("skip strip of the unchanged file :" + file,
+                                        QuasarAppUtils::Info);
+            return;
         }
 
-        return res;
-    } else {
+        auto name = file.mid(file.lastIndexOf('/') + 1);
+        auto sufixIndex = name.indexOf('.');
+        auto sufix = (sufixIndex < 0)? QString() : name.mid(sufixIndex + 1);
 
-        auto sufix = info.completeSuffix();
-        if (!sufix.contains("so") && !sufix.contains("dll")) {
-            return true;
+        if (sufix.contains("so") || sufix.contains("dll")) {
+            files.push_back(file);
         }
+    };
 
-        QProcess P;
-        P.setProgram("strip");
-        P.setArguments(QStringList() << info.absoluteFilePath());
-        P.start();
-
-        if (!P.waitForStarted())
-            return false;
-        if (!P.waitForFinished())
-            return false;
+    if (info.isDir()) {
+        for (const auto &file : DirWalker::paths(dir, DirWalker::Files | DirWalker::Parallel)) {
+            addFile(file);
+        }
+    } else {
+        addFile(info.absoluteFilePath());
+    }
 
-        return P.exitCode() == 0;
+    QString debugDir;
+    if (QuasarAppUtils::Params::isEndable("debugDir")) {
+        debugDir = QFileInfo(QuasarAppUtils::Params::getStrArg("debugDir")).absoluteFilePath();
     }
+
+    QAtomicInt failed(0);
+    QtConcurrent::blockingMap(files, [&failed, &debugDir](const QString& file) {
+        if (!stripFile(file, debugDir)) {
+            failed.fetchAndAddRelaxed(1);
+        }
+    });
+
+    return !failed.load();
 #endif
 }
 
@@ -183,25 +360,54 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
         return true;
     }
 
+    auto sourceFileAbsalutePath = QFileInfo(file).absoluteFilePath();
+    auto targetFileAbsalutePath = info.absoluteFilePath();
+    quint64 sourceHash = 0;
+
+    if (!isMove) {
+        auto sourceStat = StatCache::stat(sourceFileAbsalutePath);
+        sourceHash = DeployManifest::sourceHash(sourceFileAbsalutePath, sourceStat.size,
+                                                sourceStat.lastModified.toMSecsSinceEpoch(),
+                                                _optionsKey);
+
+        if (isUnchangedCopy(targetFileAbsalutePath, sourceHash)) {
+            QuasarAppUtils::Params::log("skip copy of the unchanged file :" + file,
+                                        QuasarAppUtils::Info);
+
+            addToDeployed(tergetFile);
+
+            QMutexLocker locker(&_deployedFilesMutex);
+            _deployedSources.insert(targetFileAbsalutePath, sourceHash);
+            _unchangedFiles.insert(targetFileAbsalutePath);
+            return true;
+        }
+    }
+
     if (!QuasarAppUtils::Params::isEndable("noOverwrite") &&
-            info.exists() && !removeFile( tergetFile)) {
+            StatCache::exists(tergetFile) && !removeFile( tergetFile)) {
         return false;
     }
 
     QuasarAppUtils::Params::log(((isMove)? "move :": "copy :") + file,
                                        QuasarAppUtils::Info);
     QFile sourceFile(file);
-    auto sourceFileAbsalutePath = QFileInfo(file).absoluteFilePath();
 
-    if (!((isMove)?
-          sourceFile.rename(tergetFile):
-          sourceFile.copy(tergetFile))) {
+    bool done = (isMove)?
+                sourceFile.rename(tergetFile):
+                sourceFile.copy(tergetFile);
+
+    StatCache::invalidate(tergetFile);
+    if (isMove) {
+        StatCache::invalidate(file);
+    }
+
+    if (!done) {
 
         QuasarAppUtils::Params::log("Qt Operation fail " + file + " >> " + tergetFile +
                                            " Qt error: " + sourceFile.errorString(),
                                            QuasarAppUtils::Warning);
 
-        bool tarExits = QFileInfo(tergetFile).exists();
+        bool tarExits = StatCache::exists(tergetFile);
 
         if ((!tarExits) ||
             (tarExits && !QuasarAppUtils::Params::isEndable("noOverwrite"))) {
@@ -213,8 +419,10 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
                                std::ios::binary);
 
             dst << src.rdbuf();
+            dst.close();
+            StatCache::invalidate(tergetFile);
 
-            if (!QFileInfo::exists(tergetFile)) {
+            if (!StatCache::exists(tergetFile)) {
                 QuasarAppUtils::Params::log("std Operation fail file not copied. "
                                                    "Сheck if you have access to the target dir",
                                                    QuasarAppUtils::Error);
@@ -224,11 +432,12 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
 
             if (isMove) {
                 std::remove(file.toStdString().c_str());
+                StatCache::invalidate(file);
             }
 
         } else {
 
-            if (QFileInfo(tergetFile).exists()) {
+            if (StatCache::exists(tergetFile)) {
                 QuasarAppUtils::Params::log(tergetFile + " already exists!",
                                                    QuasarAppUtils::Info);
                 return true;
@@ -243,6 +452,16 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
     }
 
     addToDeployed(tergetFile);
+
+    {
+        QMutexLocker locker(&_deployedFilesMutex);
+        _unchangedFiles.remove(targetFileAbsalutePath);
+
+        if (sourceHash) {
+            _deployedSources.insert(targetFileAbsalutePath, sourceHash);
+        }
+    }
+
     return true;
 }
 
@@ -284,55 +503,55 @@ bool FileManager::moveFile(const QString &file, const QString &target, QStringLi
 bool FileManager::copyFolder(const QString &from, const QString &to, const QStringList &filter,
                         QStringList *listOfCopiedItems, QStringList *mask) {
 
-    QDir fromDir(from);
-
-    auto list = fromDir.entryInfoList(QDir::NoDotAndDotDot | QDir::AllEntries);
+    const auto list = DirWalker::walk(from, DirWalker::Files | DirWalker::FollowSymlinks);
 
     for (const auto &item : list) {
-        if (QFileInfo(item).isDir()) {
+        auto fileName = item.fileName();
 
-            copyFolder(item.absoluteFilePath(), to + "/" + item.fileName(), filter, listOfCopiedItems, mask);
-        } else {
-
-            QString skipFilter = "";
-            for (const auto &i: filter) {
-                if (item.fileName().contains(i, ONLY_WIN_CASE_INSENSIATIVE)) {
-                    skipFilter = i;
-                    break;
-                }
+        QString skipFilter = "";
+        for (const auto &i: filter) {
+            if (fileName.contains(i, ONLY_WIN_CASE_INSENSIATIVE)) {
+                skipFilter = i;
+                break;
             }
+        }
 
-            if (!skipFilter.isEmpty()) {
+        if (!skipFilter.isEmpty()) {
+            QuasarAppUtils::Params::log(
+                        item.path + " ignored by filter " + skipFilter,
+                        QuasarAppUtils::VerboseLvl::Info);
+            continue;
+        }
+        auto config = DeployCore::_config;
+
+        LibInfo info;
+        info.setName(fileName);
+        info.setPath(item.dirPath());
+        info.setPlatform(GeneralFile);
+
+        if (config)
+            if (auto rule = config->ignoreList.isIgnore(info)) {
                 QuasarAppUtils::Params::log(
-                            item.absoluteFilePath() + " ignored by filter " + skipFilter,
+                            item.path + " ignored by rule " + rule->label,
                             QuasarAppUtils::VerboseLvl::Info);
                 continue;
             }
-            auto config = DeployCore::_config;
-
-            LibInfo info;
-            info.setName(item.fileName());
-            info.setPath(item.absolutePath());
-            info.setPlatform(GeneralFile);
-
-            if (config)
-                if (auto rule = config->ignoreList.isIgnore(info)) {
-                    QuasarAppUtils::Params::log(
-                                item.absoluteFilePath() + " ignored by rule " + rule->label,
-                                QuasarAppUtils::VerboseLvl::Info);
-                    continue;
-                }
 
-            if (!copyFile(item.absoluteFilePath(), to , mask)) {
-                QuasarAppUtils::Params::log(
-                            "not copied file " + to + "/" + item.fileName(),
-                            QuasarAppUtils::VerboseLvl::Warning);
-                continue;
-            }
+        // keep the structure of the subdirs of the source dir.
+        auto relativeDir = item.relativePath();
+        relativeDir.chop(fileName.size());
+        auto targetDir = to + "/" + relativeDir;
+        targetDir.chop(1);
 
-            if (listOfCopiedItems) {
-                *listOfCopiedItems << to + "/" + item.fileName();
-            }
+        if (!copyFile(item.path, targetDir, mask)) {
+            QuasarAppUtils::Params::log(
+                        "not copied file " + targetDir + "/" + fileName,
+                        QuasarAppUtils::VerboseLvl::Warning);
+            continue;
+        }
+
+        if (listOfCopiedItems) {
+            *listOfCopiedItems << targetDir + "/" + fileName;
         }
     }
 
@@ -370,13 +589,112 @@ bool FileManager::moveFolder(const QString &from, const QString &to, const QStri
     return true;
 }
 
+QString FileManager::swapOut(const QString &dir) {
+    QFileInfo info(dir);
+
+    // the working dir would be moved into the trash together with the old tree.
+    if ((QDir::currentPath() + "/").startsWith(info.absoluteFilePath() + "/")) {
+        return {};
+    }
+
+    auto trash = info.absolutePath() + "/." + info.fileName() + ".old-" +
+            QString::number(QCoreApplication::applicationPid()) + "-" +
+            QString::number(QDateTime::currentMSecsSinceEpoch());
+
+#if defined(Q_OS_LINUX) && defined(SYS_renameat2)
+    if (QDir().mkdir(trash)) {
+        if (syscall(SYS_renameat2,
+                    AT_FDCWD, QFile::encodeName(trash).constData(),
+                    AT_FDCWD, QFile::encodeName(info.absoluteFilePath()).constData(),
+                    RENAME_EXCHANGE) == 0) {
+
+            StatCache::invalidateTree(dir);
+            return trash;
+        }
+
+        // the kernel or the file system does not support the exchange.
+        QDir().rmdir(trash);
+    }
+#endif
+
+    bool renamed = QDir().rename(info.absoluteFilePath(), trash);
+    StatCache::invalidateTree(dir);
+
+    return (renamed)? trash: QString{};
+}
+
+void FileManager::removeOldTrash(const QString &dir) {
+    if (dir.isEmpty()) {
+        return;
+    }
+
+    QFileInfo info(dir);
+    auto prefix = "." + info.fileName() + ".old-";
+
+    // the trash dirs of this process are removed by the running background tasks.
+    auto ownPrefix = prefix + QString::number(QCoreApplication::applicationPid()) + "-";
+
+    const auto trashList = QDir(info.absolutePath()).entryInfoList({prefix + "*"},
+                                                                   QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+
+    for (const auto &trash : trashList) {
+        if (trash.fileName().startsWith(ownPrefix)) {
+            continue;
+        }
+
+        QuasarAppUtils::Params::log("Remove the old target dir " + trash.absoluteFilePath() +
+                                    " left by the previous deploy",
+                                    QuasarAppUtils::Info);
+
+        auto path = trash.absoluteFilePath();
+        _backgroundTasks.addFuture(QtConcurrent::run([path]() {
+            QDir(path).removeRecursively();
+        }));
+    }
+}
+
 void FileManager::clear(const QString& targetDir, bool force) {
     QuasarAppUtils::Params::log( "clear start!",
                                        QuasarAppUtils::Info);
+
+    // the previous deploy can be interrupted before the removing of its trash dir.
+    removeOldTrash(targetDir);
+
     if (force) {
         QuasarAppUtils::Params::log("clear force! " + targetDir,
                                            QuasarAppUtils::Info);
-        if (QDir(targetDir).removeRecursively()) {
+
+        // the all files of the target dir are removed, so the manifest of the dir is not needed.
+        _manifest.close();
+        if (!DeployManifest::remove(targetDir)) {
+            QuasarAppUtils::Params::log("Failed to remove the deploy manifest of " + targetDir,
+                                        QuasarAppUtils::Warning);
+        }
+
+        if (!StatCache::exists(targetDir)) {
+            QMutexLocker locker(&_deployedFilesMutex);
+            _deployedFiles.clear();
+            return;
+        }
+
+        auto trash = swapOut(targetDir);
+        if (trash.size()) {
+            _backgroundTasks.addFuture(QtConcurrent::run([trash]() {
+                if (!QDir(trash).removeRecursively()) {
+                    QuasarAppUtils::Params::log("Failed to remove the old target dir " + trash,
+                                                QuasarAppUtils::Warning);
+                }
+            }));
+
+            QMutexLocker locker(&_deployedFilesMutex);
+            _deployedFiles.clear();
+            return;
+        }
+
+        bool removed = QDir(targetDir).removeRecursively();
+        StatCache::invalidateTree(targetDir);
+
+        if (removed) {
             return;
         }
 
@@ -384,35 +702,40 @@ void FileManager::clear(const QString& targetDir, bool force) {
                                            QuasarAppUtils::Warning);
     }
 
-    QMap<int, QFileInfo> sortedOldData;
-    for (auto& i : _deployedFiles) {
-        sortedOldData.insertMulti(i.size(), QFileInfo(i));
-    }
-
-    for (auto it = sortedOldData.end(); it != sortedOldData.begin(); --it) {
+    QStringList files;
+    QStringList dirs;
+    for (const auto& path : getDeployedFiles()) {
+        auto stat = StatCache::stat(path);
 
-        auto index = it - 1;
-
-        if (!index.value().exists()) {
-            continue;
+        if (stat.isFile) {
+            files.push_back(path);
+        } else if (stat.isDir) {
+            dirs.push_back(path);
         }
+    }
 
-        if (index.value().isFile()) {
-            if (removeFile(index.value())) {
-                QuasarAppUtils::Params::log("Remove " + index.value().absoluteFilePath() + " because it is deployed file",
-                                                   QuasarAppUtils::Info);
-            }
-
-        } else {
-            QDir qdir(index.value().absoluteFilePath());
-            if (!qdir.entryList(QDir::NoDotAndDotDot | QDir::AllEntries).count()) {
-                qdir.removeRecursively();
-                QuasarAppUtils::Params::log("Remove " + index.value().absoluteFilePath() + " because it is empty",
-                                                   QuasarAppUtils::Info);
-            }
+    QtConcurrent::blockingMap(files, [this](const QString &file) {
+        if (removeFile(file)) {
+            QuasarAppUtils::Params::log("Remove " + file + " because it is deployed file",
+                                               QuasarAppUtils::Info);
+        }
+    });
+
+    // the nested dirs have the longer paths, so they are removed before the parents.
+    std::sort(dirs.begin(), dirs.end(), [](const QString& left, const QString& right) {
+        return left.size() > right.size();
+    });
+
+    for (const auto& dir : dirs) {
+        // rmdir removes only the empty dirs.
+        if (QDir().rmdir(dir)) {
+            StatCache::invalidate(dir);
+            QuasarAppUtils::Params::log("Remove " + dir + " because it is empty",
+                                               QuasarAppUtils::Info);
         }
     }
 
+    QMutexLocker locker(&_deployedFilesMutex);
     _deployedFiles.clear();
 }
 
@@ -424,11 +747,17 @@ bool FileManager::copyFile(const QString &file, const QString &target,
 
 bool FileManager::removeFile(const QFileInfo &file) {
 
-    if (!QFile::remove(file.absoluteFilePath())) {
+    bool removed = QFile::remove(file.absoluteFilePath());
+    StatCache::invalidate(file.absoluteFilePath());
+
+    if (!removed) {
         QuasarAppUtils::Params::log("Qt Operation fail (remove file) " + file.absoluteFilePath(),
                                            QuasarAppUtils::Warning);
 
-        if (remove(file.absoluteFilePath().toLatin1())) {
+        int error = remove(file.absoluteFilePath().toLatin1());
+        StatCache::invalidate(file.absoluteFilePath());
+
+        if (error) {
             QuasarAppUtils::Params::log("std Operation fail file not removed." + file.absoluteFilePath(),
                                                QuasarAppUtils::Error);
             return false;
@@ -8,9 +8,12 @@
 #ifndef COPYPASTEMANAGER_H
 #define COPYPASTEMANAGER_H
 #include <QFileInfo>
+#include <QFutureSynchronizer>
+#include <QMutex>
 #include <QSet>
 #include <QStringList>
 #include <deploy_global.h>
+#include "deploymanifest.h"
 
 
 
@@ -23,9 +26,77 @@ private:
     bool initDir(const QString &path);
     QSet<QString> _deployedFiles;
 
+    /**
+     * @brief _deployedFilesMutex - the packages deploys in the parallel, so the list of the deployed files is shared between threads.
+     */
+    mutable QMutex _deployedFilesMutex;
+
+    /**
+     * @brief _manifest - manifest of the previous deploy of the target dir.
+     */
+    DeployManifest _manifest;
+
+    /**
+     * @brief _deployedSources - hashes of the sources of the copied files (see DeployManifest::sourceHash).
+     *  key - the deployed file. Guarded by the _deployedFilesMutex.
+     */
+    QHash<QString, quint64> _deployedSources;
+
+    /**
+     * @brief _unchangedFiles - the files skipped by the isUnchangedCopy method.
+     *  They are already stripped by the previous deploy. Guarded by the _deployedFilesMutex.
+     */
+    QSet<QString> _unchangedFiles;
+
+    /**
+     * @brief _optionsKey - fingerprint of the options of the deploy, it is a part of the hashes of the sources,
+     *  because the options change the deployed files (strip, run paths).
+     */
+    QByteArray _optionsKey;
+
+    /**
+     * @brief isUnchangedCopy - check that the target file is copied by the previous deploy from the same source
+     *  and not changed after it.
+     * @param target - absolute path of the target file.
+     * @param sourceHash - hash of the source file.
+     * @return true if the copy can be skipped.
+     */
+    bool isUnchangedCopy(const QString &target, quint64 sourceHash) const;
+
+    /**
+     * @brief stripFile - strip the one file. If the debugDir is not empty
+     *  the debug info saved into the debugDir/.build-id/xx/yyyy.debug before strip.
+     *  The existing debug file of the build id is not overwritten.
+     * @return true if the file stripped successful.
+     */
+    static bool stripFile(const QString &file, const QString &debugDir);
+    static bool runTool(const QString &tool, const QStringList &args);
+
+    /**
+     * @brief _backgroundTasks - removing of the old trees started by the force clear.
+     *  The tasks are joined in the destructor.
+     */
+    QFutureSynchronizer<void> _backgroundTasks;
+
+    /**
+     * @brief swapOut - replace the dir by the empty dir and move the old tree into the trash dir next to it.
+     *  Uses the atomic exchange of the dirs (renameat2 RENAME_EXCHANGE) on linux,
+     *  else the dir is renamed to the trash dir.
+     * @param dir
+     * @return path of the trash dir or empty string if the dir can not be moved.
+     */
+    QString swapOut(const QString &dir);
+
+    /**
+     * @brief removeOldTrash - remove the trash dirs of the dir left by the interrupted deploys in the background.
+     * @param dir
+     */
+    void removeOldTrash(const QString &dir);
+
 
 public:
     FileManager();
+    ~FileManager();
 
     bool copyFile(const QString &file, const QString &target,
                   QStringList *mask = nullptr, bool targetIsFile = false);
@@ -54,18 +125,58 @@ public:
 
     bool moveFolder(const QString &from, const QString &to, const QString &ignore);
 
+    /**
+     * @brief clear - remove files of the previous deploy.
+     * @param targetDir
+     * @param force - remove the all target dir. The old tree is moved aside and removed in the background.
+     */
     void clear(const QString& targetDir, bool force);
 
 
     QStringList getDeployedFilesStringList() const;
     QSet<QString> getDeployedFiles() const;
 
+    /**
+     * @brief strip - strip all libraries of the dir in the parallel.
+     * If the debugDir option is enabled the debug info is saved into the build-id indexed tree of the debugDir.
+     * The files skipped as unchanged copies are not stripped again.
+     * @param dir - the dir or the file.
+     * @return true if all files stripped successful.
+     */
     bool strip(const QString &dir) const;
     bool addToDeployed(const QString& path);
     void removeFromDeployed(const QString& path);
 
-    void saveDeploymendFiles(const QString &targetDir);
+    /**
+     * @brief markDeployedAsUnchanged - mark all deployed files as unchanged copies,
+     *  so the next strip processes only the files copied after this call (incremental redeploy).
+     */
+    void markDeployedAsUnchanged();
+
+    /**
+     * @brief saveDeploymendFiles - save the manifest of the deployed files and the fingerprint of the deploy (see DeployManifest).
+     * @param targetDir
+     * @param fingerprint - fingerprint of the deploy (see Fingerprint), the empty fingerprint drops the saved fingerprint.
+     * @param fingerprintDirs - installation dirs used for the fingerprint.
+     */
+    void saveDeploymendFiles(const QString &targetDir,
+                             const QByteArray &fingerprint = {},
+                             const QStringList &fingerprintDirs = {});
+
+    /**
+     * @brief loadDeployemendFiles - load the list of the deployed files from the manifest of the target dir.
+     *  The lists saved into the settings by the old versions are loaded if the manifest not exists.
+     * @param targetDir
+     */
     void loadDeployemendFiles(const QString &targetDir);
+
+    /**
+     * @brief loadFingerprint - load the fingerprint saved by the saveDeploymendFiles method.
+     * @param targetDir
+     * @param fingerprintDirs - installation dirs used for the fingerprint.
+     * @return fingerprint of the previous deploy or empty array.
+     */
+    QByteArray loadFingerprint(const QString &targetDir, QStringList &fingerprintDirs) const;
 };
 
 #endif // COPYPASTEMANAGER_H
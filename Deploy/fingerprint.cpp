@@ -0,0 +1,160 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "binarysniffer.h"
+#include "deployconfig.h"
+#include "deploycore.h"
+#include "fingerprint.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <quasarapp.h>
+#include <algorithm>
+
+QByteArray Fingerprint::inputs() {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(DeployCore::getAppVersion().toUtf8());
+    hash.addData(QDir::currentPath().toUtf8());
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    for (const auto &var : QStringList{"PATH", "LD_LIBRARY_PATH"}) {
+        hash.addData((var + "=" + env.value(var) + "\n").toUtf8());
+    }
+
+    bool targetsFound = false;
+    QRegularExpression separators(QString("[") + DeployCore::getSeparator(0) + DeployCore::getSeparator(1) + "]");
+
+    // all parsed params, the help list does not contain the mode options (verify, watch...).
+    const auto params = QuasarAppUtils::Params::getUserParamsMap();
+
+    for (auto it = params.cbegin(); it != params.cend(); ++it) {
+        const auto &key = it.key();
+        const auto &value = it.value();
+
+        hash.addData((key + "=" + value + "\n").toUtf8());
+
+        bool isTarget = key == "bin" || key == "binDir";
+
+        for (const auto &item : value.split(separators, QString::SkipEmptyParts)) {
+            if (!QFileInfo::exists(item)) {
+                continue;
+            }
+
+            if (isTarget) {
+                targetsFound = true;
+                // the targets of the binDir can be found in the subdirs (see ConfigParser::setBinDir).
+                addPath(hash, item, key == "binDir", true);
+            } else {
+                // the qml sources are the inputs too, other paths (libDir, icon...) are checked only by the modification time.
+                addPath(hash, item, key == "qmlDir", false);
+            }
+        }
+    }
+
+    if (!targetsFound) {
+        return {};
+    }
+
+    return hash.result().toHex();
+}
+
+QByteArray Fingerprint::options() {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(DeployCore::getAppVersion().toUtf8());
+
+    const auto params = QuasarAppUtils::Params::getUserParamsMap();
+    for (auto it = params.cbegin(); it != params.cend(); ++it) {
+        hash.addData((it.key() + "=" + it.value() + "\n").toUtf8());
+    }
+
+    return hash.result().toHex();
+}
+
+QByteArray Fingerprint::compute(const QByteArray &inputs, const QStringList &dirs) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(inputs);
+
+    for (const auto &dir : dirs) {
+        addFile(hash, QFileInfo(dir), false);
+    }
+
+    return hash.result().toHex();
+}
+
+QStringList Fingerprint::installationDirs(const DeployConfig *config) {
+    QStringList dirs = {
+        config->qtDir.getBins(),
+        config->qtDir.getLibs(),
+        config->qtDir.getLibexecs(),
+        config->qtDir.getPlugins(),
+        config->qtDir.getQmls(),
+        config->qtDir.getTranslations(),
+        config->qtDir.getResources()
+    };
+
+    dirs += config->envirement.environmentList();
+    dirs.removeAll("");
+    dirs.removeDuplicates();
+
+    return dirs;
+}
+
+QString Fingerprint::targetDir() {
+    if (QuasarAppUtils::Params::isEndable("targetDir")) {
+        return QFileInfo(QuasarAppUtils::Params::getStrArg("targetDir")).absoluteFilePath();
+    }
+
+    return QFileInfo("./" + DISTRO_DIR).absoluteFilePath();
+}
+
+void Fingerprint::addPath(QCryptographicHash &hash, const QString &path,
+                          bool recursive, bool content) {
+    QFileInfo info(path);
+    addFile(hash, info, content);
+
+    if (!info.isDir()) {
+        return;
+    }
+
+    QStringList entries;
+    QDirIterator it(path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+
+    while (it.hasNext()) {
+        entries.push_back(it.next());
+    }
+
+    // the order of the iterator depends on the file system.
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto &entry : entries) {
+        addFile(hash, QFileInfo(entry), content);
+    }
+}
+
+void Fingerprint::addFile(QCryptographicHash &hash, const QFileInfo &info, bool content) {
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+    if (content && info.isFile() && BinarySniffer::sniff(info.absoluteFilePath()).isBinary()) {
+        QFile file(info.absoluteFilePath());
+
+        if (file.open(QIODevice::ReadOnly)) {
+            hash.addData(&file);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <QByteArray>
+#include <QStringList>
+#include "deploy_global.h"
+
+class QCryptographicHash;
+class QFileInfo;
+class DeployConfig;
+
+/**
+ * @brief The Fingerprint class - hash of the inputs of the deploy.
+ *  Used by the skipUnchanged option for skip the deploy if the inputs not changed after the previous deploy.
+ */
+class DEPLOYSHARED_EXPORT Fingerprint
+{
+public:
+
+    /**
+     * @brief inputs - fingerprint of the effective parameters, the envirement variables and the targets (size, modification time and content).
+     *  Must be called after loading of the config file, before the parsing of the parameters.
+     * @return hex string of the hash or empty array if the targets of the deploy not found.
+     */
+    static QByteArray inputs();
+
+    /**
+     * @brief options - fingerprint of the version of the deployer and the effective parameters only.
+     * @return hex string of the hash.
+     */
+    static QByteArray options();
+
+    /**
+     * @brief compute - fingerprint of the deploy.
+     * @param inputs - fingerprint of the inputs (see the inputs method).
+     * @param dirs - the qt and the envirement dirs of the deploy, the modification times of these dirs are added to the hash.
+     * @return hex string of the hash.
+     */
+    static QByteArray compute(const QByteArray& inputs, const QStringList& dirs);
+
+    /**
+     * @brief installationDirs
+     * @return the qt dirs and the envirement dirs of the parsed config.
+     */
+    static QStringList installationDirs(const DeployConfig* config);
+
+    /**
+     * @brief targetDir - target dir of the deploy by the raw parameters (see ConfigParser::setTargetDir).
+     */
+    static QString targetDir();
+
+private:
+    static void addPath(QCryptographicHash& hash, const QString& path, bool recursive, bool content);
+    static void addFile(QCryptographicHash& hash, const QFileInfo& info, bool content);
+};
+
+#endif // FINGERPRINT_H
@@ -0,0 +1,231 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "ldsocache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QtEndian>
+#include <quasarapp.h>
+#include <cstring>
+
+#define CACHE_MAGIC_OLD "ld.so-1.7.0"
+#define CACHE_MAGIC_NEW "glibc-ld.so.cache"
+#define CACHE_VERSION_NEW "1.1"
+
+// old format: magic (12 with padding), nlibs (4), entries: flags(4) key(4) value(4)
+#define CACHE_OLD_HEADER_SIZE 16
+#define CACHE_OLD_ENTRY_SIZE 12
+
+// new format: magic (17), version (3), nlibs (4), len_strings(4), flags and extension offset (8), unused (12)
+// entries: flags(4) key(4) value(4) osversion(4) hwcap(8)
+#define CACHE_NEW_HEADER_SIZE 48
+#define CACHE_NEW_ENTRY_SIZE 24
+
+#define CONFIG_MAX_INCLUDE_DEPTH 8
+
+LdSoCache::LdSoCache() {
+
+}
+
+static QString readString(const uchar *data, qint64 size, qint64 offset) {
+    if (offset < 0 || offset >= size) {
+        return "";
+    }
+
+    auto begin = reinterpret_cast<const char*>(data + offset);
+    return QString::fromUtf8(begin, static_cast<int>(qstrnlen(begin, static_cast<uint>(size - offset))));
+}
+
+void LdSoCache::addLib(const QString &soname, const QString &path) {
+    if (soname.isEmpty() || path.isEmpty()) {
+        return;
+    }
+
+    _libs.insert(soname, path);
+    _dirs.insert(QFileInfo(path).absolutePath());
+}
+
+bool LdSoCache::parseNew(const uchar *data, qint64 size, qint64 offset) {
+    if (offset + CACHE_NEW_HEADER_SIZE > size) {
+        return false;
+    }
+
+    auto nlibs = qFromUnaligned<quint32>(data + offset + 20);
+
+    if (offset + CACHE_NEW_HEADER_SIZE + static_cast<qint64>(nlibs) * CACHE_NEW_ENTRY_SIZE > size) {
+        return false;
+    }
+
+    // the string offsets of the new format are relative to the begin of the new header.
+    for (quint32 i = 0; i < nlibs; ++i) {
+        auto entry = data + offset + CACHE_NEW_HEADER_SIZE + i * CACHE_NEW_ENTRY_SIZE;
+
+        auto key = qFromUnaligned<quint32>(entry + 4);
+        auto value = qFromUnaligned<quint32>(entry + 8);
+
+        addLib(readString(data, size, offset + key), readString(data, size, offset + value));
+    }
+
+    return true;
+}
+
+bool LdSoCache::parseOld(const uchar *data, qint64 size) {
+    auto nlibs = qFromUnaligned<quint32>(data + 12);
+    qint64 strings = CACHE_OLD_HEADER_SIZE + static_cast<qint64>(nlibs) * CACHE_OLD_ENTRY_SIZE;
+
+    if (strings > size) {
+        return false;
+    }
+
+    // the new format can follow the old entries, it is aligned to 8 bytes.
+    qint64 newOffset = (strings + 7) & ~qint64(7);
+    if (newOffset + CACHE_NEW_HEADER_SIZE <= size &&
+            !memcmp(data + newOffset, CACHE_MAGIC_NEW, qstrlen(CACHE_MAGIC_NEW))) {
+        return parseNew(data, size, newOffset);
+    }
+
+    // the string offsets of the old format are relative to the end of the entries.
+    for (quint32 i = 0; i < nlibs; ++i) {
+        auto entry = data + CACHE_OLD_HEADER_SIZE + i * CACHE_OLD_ENTRY_SIZE;
+
+        auto key = qFromUnaligned<quint32>(entry + 4);
+        auto value = qFromUnaligned<quint32>(entry + 8);
+
+        addLib(readString(data, size, strings + key), readString(data, size, strings + value));
+    }
+
+    return true;
+}
+
+bool LdSoCache::load(const QString &cacheFile) {
+    QFile file(cacheFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto size = file.size();
+    auto data = file.map(0, size);
+
+    if (!data) {
+        return false;
+    }
+
+    bool result = false;
+
+    if (size >= CACHE_NEW_HEADER_SIZE &&
+            !memcmp(data, CACHE_MAGIC_NEW, qstrlen(CACHE_MAGIC_NEW)) &&
+            !memcmp(data + qstrlen(CACHE_MAGIC_NEW), CACHE_VERSION_NEW, qstrlen(CACHE_VERSION_NEW))) {
+        result = parseNew(data, size, 0);
+    } else if (size >= CACHE_OLD_HEADER_SIZE &&
+               !memcmp(data, CACHE_MAGIC_OLD, qstrlen(CACHE_MAGIC_OLD))) {
+        result = parseOld(data, size);
+    } else {
+        QuasarAppUtils::Params::log("Unknown format of the " + cacheFile,
+                                    QuasarAppUtils::Warning);
+    }
+
+    file.unmap(data);
+    file.close();
+
+    return result;
+}
+
+bool LdSoCache::parseConfig(const QString &confFile, int depth) {
+    if (depth > CONFIG_MAX_INCLUDE_DEPTH) {
+        return false;
+    }
+
+    QFile file(confFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto baseDir = QFileInfo(confFile).absolutePath();
+    auto lines = QString::fromUtf8(file.readAll()).split('\n');
+    file.close();
+
+    for (auto line : lines) {
+        line = line.left(line.indexOf('#')).trimmed();
+
+        if (line.isEmpty() || line.startsWith("hwcap")) {
+            continue;
+        }
+
+        if (line.startsWith("include")) {
+            auto pattern = line.mid(static_cast<int>(qstrlen("include"))).trimmed();
+
+            if (QDir::isRelativePath(pattern)) {
+                pattern = baseDir + "/" + pattern;
+            }
+
+            QFileInfo patternInfo(pattern);
+            auto list = QDir(patternInfo.absolutePath()).entryInfoList({patternInfo.fileName()},
+                                                                       QDir::Files, QDir::Name);
+
+            for (const auto &include : list) {
+                parseConfig(include.absoluteFilePath(), depth + 1);
+            }
+
+            continue;
+        }
+
+        // the old syntax allows the dirs separated by spaces, tabs, commas and colons.
+        for (const auto &dir : line.split(QRegExp("[\\s,:]+"), QString::SkipEmptyParts)) {
+            if (QFileInfo(dir).isDir()) {
+                _dirs.insert(QDir(dir).absolutePath());
+            }
+        }
+    }
+
+    return true;
+}
+
+bool LdSoCache::loadConfig(const QString &confFile) {
+    return parseConfig(confFile, 0);
+}
+
+QStringList LdSoCache::libraries(const QString &soname) const {
+    return _libs.values(soname);
+}
+
+QStringList LdSoCache::dirs() const {
+    return _dirs.values();
+}
+
+bool LdSoCache::isEmpty() const {
+    return _dirs.isEmpty();
+}
+
+const LdSoCache &LdSoCache::system() {
+    static const LdSoCache cache = []() {
+        LdSoCache result;
+
+        if (!result.load()) {
+            QuasarAppUtils::Params::log("Failed to read " + QString(LD_SO_CACHE),
+                                        QuasarAppUtils::Warning);
+        }
+
+        result.loadConfig();
+
+        if (!result.isEmpty()) {
+            // the trusted dirs are searched by the loader always.
+            for (const auto &dir : {"/lib", "/usr/lib", "/lib64", "/usr/lib64"}) {
+                if (QFileInfo(dir).isDir()) {
+                    result._dirs.insert(dir);
+                }
+            }
+        }
+
+        return result;
+    }();
+
+    return cache;
+}
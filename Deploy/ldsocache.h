@@ -0,0 +1,72 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef LDSOCACHE_H
+#define LDSOCACHE_H
+
+#include <QMultiHash>
+#include <QSet>
+#include <QStringList>
+#include "deploy_global.h"
+
+#define LD_SO_CACHE "/etc/ld.so.cache"
+#define LD_SO_CONF "/etc/ld.so.conf"
+
+/**
+ * @brief The LdSoCache class - reader of the cache of the dynamic loader (ld.so.cache) and the ld.so.conf.
+ * Supports the old (ld.so-1.7.0) and the new (glibc-ld.so.cache1.1) formats of the cache.
+ */
+class DEPLOYSHARED_EXPORT LdSoCache
+{
+public:
+    LdSoCache();
+
+    /**
+     * @brief load - read the cache of the dynamic loader.
+     * @param cacheFile - path to the cache file.
+     * @return true if the cache read successful.
+     */
+    bool load(const QString& cacheFile = LD_SO_CACHE);
+
+    /**
+     * @brief loadConfig - read the library dirs from the config of the dynamic loader (include directives are supported).
+     * @param confFile - path to the config file.
+     * @return true if the config read successful.
+     */
+    bool loadConfig(const QString& confFile = LD_SO_CONF);
+
+    /**
+     * @brief libraries
+     * @param soname - name of the library.
+     * @return list of the full paths of the library from the cache.
+     */
+    QStringList libraries(const QString& soname) const;
+
+    /**
+     * @brief dirs
+     * @return list of the dirs that contains the cached libraries and the dirs of the config.
+     */
+    QStringList dirs() const;
+
+    bool isEmpty() const;
+
+    /**
+     * @brief system - return the cache of the system, the cache is read once.
+     */
+    static const LdSoCache& system();
+
+private:
+    QMultiHash<QString, QString> _libs;
+    QSet<QString> _dirs;
+
+    bool parseNew(const uchar* data, qint64 size, qint64 offset);
+    bool parseOld(const uchar* data, qint64 size);
+    void addLib(const QString& soname, const QString& path);
+    bool parseConfig(const QString& confFile, int depth);
+};
+
+#endif // LDSOCACHE_H
@@ -11,98 +11,256 @@
 #include <QFileInfo>
 #include <QSet>
 #include <QVector>
-#include <parser-library/parse.h>
+#include <QtEndian>
 #include <quasarapp.h>
 
-#include <bits/stl_set.h>
-
-namespace peparse {
+#define PE_DOS_MAGIC 0x5A4D // MZ
+#define PE_SIGNATURE 0x00004550 // PE\0\0
+#define PE_COFF_HEADER_SIZE 20
+#define PE_SECTION_HEADER_SIZE 40
+#define PE_IMPORT_DESCRIPTOR_SIZE 20
+#define PE_DELAY_IMPORT_DESCRIPTOR_SIZE 32
+#define PE_DIRECTORY_IMPORT 1
+#define PE_DIRECTORY_DELAY_IMPORT 13
+#define PE_MAX_NAME_SIZE 256
+
+namespace {
+
+template <typename T>
+bool readValue(const uchar *data, qint64 size, qint64 offset, T& value) {
+    if (offset < 0 || offset + static_cast<qint64>(sizeof(T)) > size) {
+        return false;
+    }
 
-class section;
+    value = qFromLittleEndian<T>(data + offset);
+    return true;
+}
 
-struct importent {
-  VA addr;
-  std::string symbolName;
-  std::string moduleName;
-};
+bool readName(const uchar *data, qint64 size, qint64 offset, QString& name) {
+    if (offset < 0 || offset >= size) {
+        return false;
+    }
 
-struct exportent {
-  VA addr;
-  std::string symbolName;
-  std::string moduleName;
-};
+    auto begin = reinterpret_cast<const char*>(data + offset);
+    auto length = qstrnlen(begin, static_cast<uint>(qMin<qint64>(size - offset, PE_MAX_NAME_SIZE)));
 
-class reloc;
-class symbol;
+    if (!length) {
+        return false;
+    }
 
-struct parsed_pe_internal {
-  std::vector<section> secs;
-  std::vector<resource> rsrcs;
-  std::vector<importent> imports;
-  std::vector<reloc> relocs;
-  std::vector<exportent> exports;
-  std::vector<symbol> symbols;
-};
+    name = QString::fromLatin1(begin, static_cast<int>(length));
+    return true;
+}
 
 }
 
-bool PE::getDep(peparse::parsed_pe_internal * internal, LibInfo &res) const {
-    auto imports = internal->imports;
-    std::set<std::string> filter;
+qint64 PE::rvaToOffset(const QVector<Section> &sections, quint32 rva) {
+    for (const auto &section : sections) {
+        auto sectionSize = qMax(section.virtualSize, section.rawSize);
 
-    for ( auto &i : imports) {
-        if (!filter.count(i.moduleName)) {
-            filter.insert(i.moduleName);
-            res.addDependncies(QString::fromStdString(i.moduleName));
+        if (rva >= section.virtualAddress && rva - section.virtualAddress < sectionSize) {
+            if (rva - section.virtualAddress >= section.rawSize) {
+                // the rva points to the uninitialized data of the section.
+                return -1;
+            }
+
+            return static_cast<qint64>(section.rawOffset) + (rva - section.virtualAddress);
         }
     }
 
-    if (res.getWinApi() != WinAPI::NoWinAPI) {
-        res.addDependncies(_winAPI.value(res.getWinApi()));
+    // the rva points to the headers.
+    if (sections.size() && rva < sections.first().rawOffset) {
+        return rva;
     }
 
-    return res.getDependncies().size() || !imports.size();
+    return -1;
 }
 
-QHash<WinAPI, QSet<QString> > PE::getWinAPI() const {
-    return _winAPI;
-}
+bool PE::readImports(const uchar *data, qint64 size, RunType &type, Imports &result) const {
+    quint16 dosMagic = 0;
+    quint32 peOffset = 0;
 
-void PE::setWinAPI(const QHash<WinAPI, QSet<QString> > &winAPI) {
-    _winAPI = winAPI;
-}
+    if (!readValue(data, size, 0, dosMagic) || dosMagic != PE_DOS_MAGIC ||
+            !readValue(data, size, 0x3C, peOffset)) {
+        return false;
+    }
 
-WinAPI PE::getAPIModule(const QString &libName) const {
-    if (libName.contains(API_MS_WIN, Qt::CaseInsensitive)) {
-        if (libName.contains(API_MS_WIN_CORE, Qt::CaseInsensitive)) {
-            return WinAPI::Core;
+    quint32 signature = 0;
+    if (!readValue(data, size, peOffset, signature) || signature != PE_SIGNATURE) {
+        return false;
+    }
+
+    qint64 coffHeader = static_cast<qint64>(peOffset) + 4;
+    quint16 sectionsCount = 0;
+    quint16 optionalHeaderSize = 0;
+
+    if (!readValue(data, size, coffHeader + 2, sectionsCount) ||
+            !readValue(data, size, coffHeader + 16, optionalHeaderSize)) {
+        return false;
+    }
+
+    qint64 optionalHeader = coffHeader + PE_COFF_HEADER_SIZE;
+    quint16 magic = 0;
+    if (!readValue(data, size, optionalHeader, magic)) {
+        return false;
+    }
+
+    type = static_cast<RunType>(magic);
+
+    quint64 imageBase = 0;
+    qint64 directoriesCountOffset = 0;
+
+    if (type == RunType::_32bit) {
+        quint32 base32 = 0;
+        if (!readValue(data, size, optionalHeader + 28, base32)) {
+            return false;
+        }
+        imageBase = base32;
+        directoriesCountOffset = 92;
+    } else if (type == RunType::_64bit) {
+        if (!readValue(data, size, optionalHeader + 24, imageBase)) {
+            return false;
         }
+        directoriesCountOffset = 108;
+    } else {
+        return false;
+    }
+
+    quint32 directoriesCount = 0;
+    if (!readValue(data, size, optionalHeader + directoriesCountOffset, directoriesCount)) {
+        return false;
+    }
 
-        if (libName.contains(API_MS_WIN_EVENTING, Qt::CaseInsensitive)) {
-            return WinAPI::Eventing;
+    qint64 directories = optionalHeader + directoriesCountOffset + 4;
+
+    QVector<Section> sections;
+    sections.reserve(sectionsCount);
+
+    qint64 sectionTable = optionalHeader + optionalHeaderSize;
+    for (int i = 0; i < sectionsCount; ++i) {
+        qint64 sectionHeader = sectionTable + i * PE_SECTION_HEADER_SIZE;
+        Section section;
+
+        if (!readValue(data, size, sectionHeader + 8, section.virtualSize) ||
+                !readValue(data, size, sectionHeader + 12, section.virtualAddress) ||
+                !readValue(data, size, sectionHeader + 16, section.rawSize) ||
+                !readValue(data, size, sectionHeader + 20, section.rawOffset)) {
+            return false;
         }
 
-        if (libName.contains(API_MS_WIN_DEVICES, Qt::CaseInsensitive)) {
-            return WinAPI::Devices;
+        sections.push_back(section);
+    }
+
+    auto directoryRva = [&](int index) -> quint32 {
+        quint32 rva = 0;
+        if (static_cast<quint32>(index) >= directoriesCount ||
+                (directories + index * 8) >= optionalHeader + optionalHeaderSize ||
+                !readValue(data, size, directories + index * 8, rva)) {
+            return 0;
         }
 
-        if (libName.contains(API_MS_WIN_CRT, Qt::CaseInsensitive)) {
-            return WinAPI::Crt;
+        return rva;
+    };
+
+    if (auto importRva = directoryRva(PE_DIRECTORY_IMPORT)) {
+        auto descriptor = rvaToOffset(sections, importRva);
+
+        while (descriptor >= 0) {
+            quint32 nameRva = 0;
+            if (!readValue(data, size, descriptor + 12, nameRva) || !nameRva) {
+                break;
+            }
+
+            QString name;
+            if (readName(data, size, rvaToOffset(sections, nameRva), name)) {
+                result.imports.push_back(name);
+            }
+
+            descriptor += PE_IMPORT_DESCRIPTOR_SIZE;
         }
+    }
+
+    if (auto delayImportRva = directoryRva(PE_DIRECTORY_DELAY_IMPORT)) {
+        auto descriptor = rvaToOffset(sections, delayImportRva);
 
-        if (libName.contains(API_MS_WIN_SECURITY, Qt::CaseInsensitive)) {
-            return WinAPI::Security;
+        while (descriptor >= 0) {
+            quint32 attributes = 0;
+            quint32 nameRva = 0;
+            if (!readValue(data, size, descriptor, attributes) ||
+                    !readValue(data, size, descriptor + 4, nameRva) || !nameRva) {
+                break;
+            }
+
+            // old linkers (vc6) write the virtual addresses instead of rva.
+            if (!(attributes & 0x1)) {
+                nameRva = static_cast<quint32>(nameRva - imageBase);
+            }
+
+            QString name;
+            if (readName(data, size, rvaToOffset(sections, nameRva), name)) {
+                result.delayImports.push_back(name);
+            }
+
+            descriptor += PE_DELAY_IMPORT_DESCRIPTOR_SIZE;
         }
+    }
+
+    return true;
+}
+
+bool PE::getDep(const Imports &imports, LibInfo &res) const {
+    QSet<QString> filter;
 
-        if (libName.contains(API_MS_WIN_BASE, Qt::CaseInsensitive)) {
-            return WinAPI::Base;
+    // the delay loaded modules are loaded on the first call, so they are required too.
+    for (const auto &list : {imports.imports, imports.delayImports}) {
+        for (const auto &moduleName : list) {
+            if (!filter.contains(moduleName)) {
+                filter.insert(moduleName);
+                res.addDependncies(moduleName);
+            }
         }
+    }
+
+    if (res.getWinApi() != WinAPI::NoWinAPI) {
+        res.addDependncies(_winAPI.value(res.getWinApi()));
+    }
+
+    return res.getDependncies().size() || (!imports.imports.size() && !imports.delayImports.size());
+}
+
+QHash<WinAPI, QSet<QString> > PE::getWinAPI() const {
+    return _winAPI;
+}
 
-        return WinAPI::Other;
+void PE::setWinAPI(const QHash<WinAPI, QSet<QString> > &winAPI) {
+    _winAPI = winAPI;
+}
 
+const QHash<QString, WinAPI> &PE::apiSetFamilies() {
+    static const QHash<QString, WinAPI> families = {
+        {"core", WinAPI::Core},
+        {"eventing", WinAPI::Eventing},
+        {"devices", WinAPI::Devices},
+        {"crt", WinAPI::Crt},
+        {"security", WinAPI::Security},
+        {"base", WinAPI::Base},
+    };
+
+    return families;
+}
+
+WinAPI PE::getAPIModule(const QString &libName) const {
+    // the ext-ms-win- libraries are not the api sets.
+    if (!libName.startsWith(API_MS_WIN, Qt::CaseInsensitive)) {
+        return WinAPI::NoWinAPI;
     }
 
-    return WinAPI::NoWinAPI;
+    auto prefixSize = static_cast<int>(qstrlen(API_MS_WIN));
+
+    auto familyEnd = libName.indexOf('-', prefixSize);
+    auto family = libName.mid(prefixSize, familyEnd - prefixSize).toLower();
+
+    return apiSetFamilies().value(family, WinAPI::Other);
 }
 
 PE::PE(): IGetLibInfo () {
@@ -110,14 +268,33 @@ PE::PE(): IGetLibInfo () {
 }
 
 bool PE::getLibInfo(const QString &lib, LibInfo &info) const {
-    auto parsedPeLib = peparse::ParsePEFromFile(lib.toLatin1());
+    QFile file(lib);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto size = file.size();
+    auto data = file.map(0, size);
 
-    if (!parsedPeLib)
+    if (!data) {
         return false;
+    }
+
+    RunType type = RunType::_UNKNOWN;
+    Imports imports;
+    bool valid = readImports(data, size, type, imports);
+
+    file.unmap(data);
+    file.close();
 
-    if (static_cast<RunType>(parsedPeLib->peHeader.nt.OptionalMagic) == RunType::_32bit) {
+    if (!valid) {
+        return false;
+    }
+
+    if (type == RunType::_32bit) {
         info.setPlatform(Platform::Win32);
-    } else if (static_cast<RunType>(parsedPeLib->peHeader.nt.OptionalMagic) == RunType::_64bit) {
+    } else if (type == RunType::_64bit) {
         info.setPlatform(Platform::Win64);
     } else {
         info.setPlatform(Platform::UnknownPlatform);
@@ -127,14 +304,10 @@ bool PE::getLibInfo(const QString &lib, LibInfo &info) const {
     info.setPath(QFileInfo(lib).absolutePath());
     info.setWinApi(getAPIModule(info.getName()));
 
-    if (!getDep(parsedPeLib->internal, info)) {
-        peparse::DestructParsedPE(parsedPeLib);
+    if (!getDep(imports, info)) {
         return false;
     }
 
-    peparse::DestructParsedPE(parsedPeLib);
-
-
     return info.isValid();
 }
 
@@ -10,26 +10,13 @@
 
 #include <QFile>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include "igetlibinfo.h"
 
 #define API_MS_WIN "api-ms-win-"
-#define API_MS_WIN_CORE "-core-"
-#define API_MS_WIN_EVENTING "-Eventing-"
-#define API_MS_WIN_DEVICES "-devices-"
-#define API_MS_WIN_CRT "-crt-"
-#define API_MS_WIN_SECURITY "-security-"
-#define API_MS_WIN_BASE "-base-"
-
-namespace peparse {
-struct parsed_pe_internal;
-}
-class PE : public IGetLibInfo {
-
-private:
 
-    bool getDep(peparse::parsed_pe_internal *, LibInfo &res) const;
-    QHash<WinAPI, QSet<QString>> _winAPI;
+class PE : public IGetLibInfo {
 
 public:
 
@@ -39,6 +26,53 @@ public:
         _64bit = 0x20B,
         _ROM = 0x107,
     };
+
+private:
+
+    /**
+     * @brief The Section struct - record of the section table, used for convert rva to the file offset.
+     */
+    struct Section {
+        quint32 virtualAddress = 0;
+        quint32 virtualSize = 0;
+        quint32 rawSize = 0;
+        quint32 rawOffset = 0;
+    };
+
+    /**
+     * @brief The Imports struct - names of the imported modules of the pe file.
+     */
+    struct Imports {
+        QStringList imports;
+        QStringList delayImports;
+    };
+
+    static qint64 rvaToOffset(const QVector<Section>& sections, quint32 rva);
+
+    /**
+     * @brief readImports - read only the headers, the import directory
+     *  and the delay import directory of the mapped pe file.
+     * @param data - mapped file.
+     * @param size - size of the mapped file.
+     * @param type - optional header magic.
+     * @param result - names of the imported modules.
+     * @return true if the file is valid pe file.
+     */
+    bool readImports(const uchar *data, qint64 size, RunType &type, Imports &result) const;
+
+    bool getDep(const Imports &imports, LibInfo &res) const;
+
+    /**
+     * @brief apiSetFamilies
+     * @return table of the api set families (first token after the api-ms-win- prefix). The table is built once.
+     */
+    static const QHash<QString, WinAPI>& apiSetFamilies();
+    QHash<WinAPI, QSet<QString>> _winAPI;
+
+    friend class deploytest;
+
+public:
+
     PE();
     WinAPI getAPIModule(const QString &libName) const;
 
@@ -6,6 +6,7 @@
  */
 
 #include "qml.h"
+#include "dirwalker.h"
 
 #include <QDir>
 #include <QFile>
@@ -129,14 +130,13 @@ bool QML::scanQmlTree(const QString &qmlTree) {
         return false;
     }
 
-    auto list = dir.entryInfoList( QDir::Dirs | QDir::NoDotAndDotDot);
+    const auto list = DirWalker::walk(qmlTree, DirWalker::Dirs | DirWalker::FollowSymlinks);
 
     for (const auto &info : list) {
-        if (info.fileName().contains(".2")) {
-            secondVersions.insert(info.fileName().left(info.fileName().size() - 2));
+        auto fileName = info.fileName();
+        if (fileName.contains(".2")) {
+            secondVersions.insert(fileName.left(fileName.size() - 2));
         }
-        scanQmlTree(info.absoluteFilePath());
-
     }
 
     return true;
@@ -0,0 +1,115 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "statcache.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+QHash<QString, FileStat> StatCache::_cache;
+quint64 StatCache::_generation = 0;
+QReadWriteLock StatCache::_lock;
+
+QString StatCache::key(const QString &path) {
+    if (QDir::isRelativePath(path)) {
+        return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    }
+
+    return QDir::cleanPath(path);
+}
+
+FileStat StatCache::stat(const QString &path) {
+    if (path.isEmpty()) {
+        return {};
+    }
+
+    auto cacheKey = key(path);
+    quint64 generation = 0;
+
+    {
+        QReadLocker locker(&_lock);
+        auto it = _cache.constFind(cacheKey);
+        if (it != _cache.constEnd()) {
+            return *it;
+        }
+
+        generation = _generation;
+    }
+
+    QFileInfo info(cacheKey);
+    FileStat result;
+    result.exists = info.exists();
+
+    if (result.exists) {
+        result.isFile = info.isFile();
+        result.isDir = info.isDir();
+        result.size = info.size();
+        result.lastModified = info.lastModified();
+    }
+
+    QWriteLocker locker(&_lock);
+
+    // the path can be changed and invalidated while the metadata was read.
+    if (generation == _generation) {
+        _cache.insert(cacheKey, result);
+    }
+
+    return result;
+}
+
+bool StatCache::exists(const QString &path) {
+    return stat(path).exists;
+}
+
+bool StatCache::isFile(const QString &path) {
+    return stat(path).isFile;
+}
+
+bool StatCache::isDir(const QString &path) {
+    return stat(path).isDir;
+}
+
+void StatCache::invalidate(const QString &path) {
+    auto cacheKey = key(path);
+
+    QWriteLocker locker(&_lock);
+    _generation++;
+
+    // the parent dirs can be created together with the file (mkpath).
+    while (!cacheKey.isEmpty()) {
+        _cache.remove(cacheKey);
+
+        auto index = cacheKey.lastIndexOf('/');
+        if (index < 0) {
+            break;
+        }
+
+        cacheKey.truncate(index);
+    }
+}
+
+void StatCache::invalidateTree(const QString &path) {
+    invalidate(path);
+
+    auto prefix = key(path) + "/";
+
+    QWriteLocker locker(&_lock);
+    _generation++;
+    for (auto it = _cache.begin(); it != _cache.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = _cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void StatCache::clear() {
+    QWriteLocker locker(&_lock);
+    _generation++;
+    _cache.clear();
+}
@@ -0,0 +1,69 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef STATCACHE_H
+#define STATCACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include "deploy_global.h"
+
+/**
+ * @brief The FileStat struct - metadata of the file.
+ */
+struct DEPLOYSHARED_EXPORT FileStat {
+    bool exists = false;
+    bool isFile = false;
+    bool isDir = false;
+    qint64 size = 0;
+    QDateTime lastModified;
+};
+
+/**
+ * @brief The StatCache class - run-scoped cache of the metadata of the files (thread safe).
+ *  The cache is cleared on the start of each deploy.
+ *  All writes of the deploy (copy, remove, strip, patch of the files) must invalidate the changed paths.
+ */
+class DEPLOYSHARED_EXPORT StatCache
+{
+public:
+    static FileStat stat(const QString& path);
+
+    static bool exists(const QString& path);
+    static bool isFile(const QString& path);
+    static bool isDir(const QString& path);
+
+    /**
+     * @brief invalidate - drop the metadata of the path and its parent dirs.
+     *  Call it after the file is created, changed or removed.
+     */
+    static void invalidate(const QString& path);
+
+    /**
+     * @brief invalidateTree - drop the metadata of the path and all entries inside it.
+     *  Call it after the dir is removed or moved.
+     */
+    static void invalidateTree(const QString& path);
+
+    static void clear();
+
+private:
+    static QString key(const QString& path);
+
+    static QHash<QString, FileStat> _cache;
+
+    /**
+     * @brief _generation - counter of the invalidations. The metadata read outside of the lock is not saved
+     *  if the counter is changed during the reading, because the read result can be outdated.
+     */
+    static quint64 _generation;
+    static QReadWriteLock _lock;
+};
+
+#endif // STATCACHE_H
@@ -0,0 +1,231 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#include "verifier.h"
+#include "dependenciesscanner.h"
+#include "deployconfig.h"
+#include "envirement.h"
+#include "ldsocache.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <quasarapp.h>
+
+Verifier::Verifier(DependenciesScanner *scaner) {
+    _scaner = scaner;
+}
+
+bool Verifier::verify() {
+    auto cnf = DeployCore::_config;
+
+    if (!QFileInfo(cnf->getTargetDir()).isDir()) {
+        QuasarAppUtils::Params::log("The distribution not exists: " + cnf->getTargetDir(),
+                                    QuasarAppUtils::Error);
+        return false;
+    }
+
+    initHostLibs();
+
+    _missing = 0;
+    _leaked = 0;
+    _checked = 0;
+
+    bool result = true;
+    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+        result = verifyPackage(i.key()) && result;
+    }
+
+    QuasarAppUtils::Params::log(QString("verify: checked %0 binaries, %1 missing and %2 host libraries found").
+                                arg(_checked).arg(_missing).arg(_leaked),
+                                (result)? QuasarAppUtils::Info: QuasarAppUtils::Error);
+
+    return result;
+}
+
+void Verifier::initHostLibs() {
+    if (_hostLibs.size()) {
+        return;
+    }
+
+    QStringList dirs;
+
+#ifdef Q_OS_WIN
+    auto winDir = QProcessEnvironment::systemEnvironment().value("SystemRoot", "C:/Windows");
+    dirs += Envirement::recursiveInvairement(winDir + "/System32", 2);
+    dirs += Envirement::recursiveInvairement(winDir + "/SysWOW64", 2);
+#else
+    auto &ldCache = LdSoCache::system();
+
+    if (!ldCache.isEmpty()) {
+        dirs += ldCache.dirs();
+    } else {
+        dirs += Envirement::recursiveInvairement("/lib", 3);
+        dirs += Envirement::recursiveInvairement("/usr/lib", 3);
+    }
+#endif
+
+    for (const auto &dir : dirs) {
+        auto list = QDir(dir).entryInfoList(QStringList() << "*.dll" << "*.DLL" << "*.so*",
+                                            QDir::Files | QDir::NoDotAndDotDot);
+
+        for (const auto &lib : list) {
+            _hostLibs.insert(lib.fileName().toUpper(), lib.absoluteFilePath());
+        }
+    }
+}
+
+QStringList Verifier::searchDirs(const LibInfo &binary, const QString &packageDir,
+                                 const QString &libDir, const QString &binDir) const {
+    QStringList result;
+
+    // the run path works only for the dirs inside the distribution.
+    for (auto path : _elf.getRunPath(binary.fullPath())) {
+        path.replace("${ORIGIN}", binary.getPath());
+        path.replace("$ORIGIN", binary.getPath());
+        path = QDir::cleanPath(path);
+
+        if (path.startsWith(packageDir)) {
+            result.push_back(path);
+        }
+    }
+
+    // the run script adds the lib dir and the root of the package ($BASE_DIR) to the LD_LIBRARY_PATH.
+    result.push_back(libDir);
+    result.push_back(packageDir);
+
+    // the windows loader searches in the dir of the executable and in the dir of the library,
+    // the linux loader uses only the run path and the LD_LIBRARY_PATH.
+    if (binary.getPlatform() & Platform::Win) {
+        result.push_back(binDir);
+        result.push_back(binary.getPath());
+    }
+
+    return result;
+}
+
+bool Verifier::isSystemLib(const LibInfo &binary, const QString &libName, QString *hostPath) const {
+    if (libName.startsWith("API-MS-WIN", Qt::CaseInsensitive) ||
+            libName.startsWith("EXT-MS-WIN", Qt::CaseInsensitive)) {
+        return true;
+    }
+
+    auto hostLibs = _hostLibs.values(libName.toUpper());
+
+    for (const auto &lib : hostLibs) {
+        LibInfo info;
+        info.setName(QFileInfo(lib).fileName());
+        info.setPath(QFileInfo(lib).absolutePath());
+        info.setPlatform(binary.getPlatform());
+        info.setPriority(DeployCore::getLibPriority(lib));
+
+        if (DeployCore::_config->ignoreList.isIgnore(info)) {
+            return true;
+        }
+    }
+
+    if (hostPath && hostLibs.size()) {
+        *hostPath = hostLibs.first();
+    }
+
+    return false;
+}
+
+bool Verifier::verifyPackage(const QString &package) {
+    auto cnf = DeployCore::_config;
+    auto distro = cnf->getDistroFromPackage(package);
+
+    auto packageDir = QDir(cnf->getTargetDir() + "/" + package).absolutePath();
+    auto libDir = QDir(packageDir + distro.getLibOutDir()).absolutePath();
+    auto binDir = QDir(packageDir + distro.getBinOutDir()).absolutePath();
+
+    // the dirs of the other packages can be placed inside this package (default package).
+    QStringList otherPackages;
+    for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
+        auto dir = QDir(cnf->getTargetDir() + "/" + i.key()).absolutePath();
+        if (i.key() != package && dir.startsWith(packageDir)) {
+            otherPackages.push_back(dir + "/");
+        }
+    }
+
+    QMultiHash<QString, QString> bundle;
+    QStringList binaries;
+
+    QDirIterator it(packageDir, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        auto info = it.fileInfo();
+
+        bool otherPackage = false;
+        for (const auto &dir : otherPackages) {
+            if (info.absoluteFilePath().startsWith(dir)) {
+                otherPackage = true;
+                break;
+            }
+        }
+
+        if (otherPackage) {
+            continue;
+        }
+
+        bundle.insert(info.fileName().toUpper(), info.absolutePath());
+
+        if (DeployCore::isLib(info) || DeployCore::isExecutable(info)) {
+            binaries.push_back(info.absoluteFilePath());
+        }
+    }
+
+    bool result = true;
+
+    for (const auto &binary : binaries) {
+        LibInfo info;
+
+        if (!_scaner->fillLibInfo(info, binary)) {
+            continue;
+        }
+
+        _checked++;
+        auto dirs = searchDirs(info, packageDir, libDir, binDir);
+
+        for (const auto &dep : info.getDependncies()) {
+            auto depDirs = bundle.values(dep.toUpper());
+
+            bool found = false;
+            for (const auto &dir : dirs) {
+                if (depDirs.contains(dir)) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (found) {
+                continue;
+            }
+
+            QString hostPath;
+            if (isSystemLib(info, dep, &hostPath)) {
+                continue;
+            }
+
+            result = false;
+
+            if (hostPath.size()) {
+                _leaked++;
+                QuasarAppUtils::Params::log(binary + ": " + dep + " is not deployed and is loaded from the host (" +
+                                            hostPath + ")",
+                                            QuasarAppUtils::Error);
+            } else {
+                _missing++;
+                QuasarAppUtils::Params::log(binary + ": " + dep + " not found",
+                                            QuasarAppUtils::Error);
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,62 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <QMultiHash>
+#include <QStringList>
+#include "deploy_global.h"
+#include "elf.h"
+
+class DependenciesScanner;
+
+/**
+ * @brief The Verifier class - check that the deployed distribution is self-contained without running it.
+ * The dependencies of the each deployed binary are resolved only inside the package dir,
+ * like the dynamic loader does with the run script or the run path of the binary.
+ */
+class DEPLOYSHARED_EXPORT Verifier
+{
+public:
+    explicit Verifier(DependenciesScanner *scaner);
+
+    /**
+     * @brief verify - check all packages of the distribution.
+     * @return true if all dependencies are found inside the distribution or are provided by the system.
+     */
+    bool verify();
+
+private:
+    DependenciesScanner *_scaner = nullptr;
+    ELF _elf;
+
+    /**
+     * @brief _hostLibs - libraries of the system dirs. key - upper case name of the library, value - full path.
+     */
+    QMultiHash<QString, QString> _hostLibs;
+
+    int _missing = 0;
+    int _leaked = 0;
+    int _checked = 0;
+
+    void initHostLibs();
+    bool verifyPackage(const QString& package);
+
+    QStringList searchDirs(const LibInfo& binary, const QString& packageDir,
+                           const QString& libDir, const QString& binDir) const;
+
+    /**
+     * @brief isSystemLib
+     * @return true if the library is provided by the system of the user (for example libc or kernel32).
+     */
+    bool isSystemLib(const LibInfo& binary, const QString& libName, QString *hostPath) const;
+
+    friend class deploytest;
+};
+
+#endif // VERIFIER_H
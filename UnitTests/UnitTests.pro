@@ -17,7 +17,6 @@ CONFIG(release, debug|release): {
 
 include('$$PWD/../QuasarAppLib/QuasarLib.pri')
 include('$$PWD/../Deploy/Deploy.pri')
-include('$$PWD/../pe/pe-parser-library/pe-parser-library.pri')
 
 
 QT_DIR = $$[QT_HOST_BINS]/../
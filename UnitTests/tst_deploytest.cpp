@@ -18,10 +18,25 @@
 #include <pathutils.h>
 #include <dependencymap.h>
 #include <packing.h>
+#include <ldsocache.h>
+#include <binarysniffer.h>
+#include <dirwalker.h>
+#include <statcache.h>
+#include <deploymanifest.h>
+#include <batchdeploy.h>
+#include <deployserver.h>
+#include <pe.h>
+#include <elf.h>
+#include <deploywatcher.h>
+#include <filemanager.h>
+#include <verifier.h>
+#include <fingerprint.h>
 
 #include <QMap>
 #include <QByteArray>
 #include <QDir>
+#include <QScopedArrayPointer>
+#include <QtEndian>
 #include <thread>
 #include "libcreator.h"
 #include "modules.h"
@@ -143,6 +158,56 @@ private slots:
     void testInit();
 
     void testDependencyMap();
+
+    void testLdSoCache();
+
+    void testBinarySniffer();
+
+    void testDirWalker();
+
+    void testStatCache();
+
+    void testExtractTranslation();
+
+    void testDeployManifest();
+
+    void testEnvirementLookup();
+
+    // tested flag confFile with many configuration files
+    void testBatchDeploy();
+
+    // tested the resident deploy server
+    void testDeployServer();
+
+    void testPEImports();
+
+    void testSetRunPath();
+
+    // tested flag watch
+    void testWatch();
+
+    // tested flag pruneUnusedLibs
+    void testPruneUnusedLibs();
+
+    // tested flag skipUnchanged
+    void testSkipUnchanged();
+
+    // tested flag noRunQmake and the cache of the qmake query
+    void testQmakeQuery();
+
+    // tested the targets discovery of the binDir flag
+    void testBinDirDiscovery();
+    void testScanerCacheTargetDir();
+    void testEnvLookupCache();
+
+    // tested flag verify
+    void testVerify();
+
+    // tested flag debugDir
+    void testDebugDir();
+
+    // tested the search of the qmake in the PATH
+    void testFindProcess();
 };
 
 bool deploytest::runProcess(const QString &DistroPath,
@@ -717,8 +782,31 @@ void deploytest::testDependencyMap() {
     QVERIFY(dep1.qtModules() == (DeployCore::QtModule::QtGuiModule |
             DeployCore::QtModule::QtHelpModule));
 
-
-
+    dep1.addNeadedLib("/depmap/libA.so");
+    dep1.addNeadedLib("/depmap/libB.so");
+    dep1.addSystemLib("/depmap/libSys.so");
+    dep2.addNeadedLib("/depmap/libB.so");
+    dep2.addNeadedLib("/depmap/libC.so");
+
+    QVERIFY(dep1.containsNeadedLib("/depmap/libA.so"));
+    QVERIFY(!dep1.containsNeadedLib("/depmap/libC.so"));
+    QVERIFY(!dep1.containsNeadedLib("/depmap/unknown.so"));
+    QVERIFY(dep1.containsSysLib("/depmap/libSys.so"));
+
+    dep3 = dep1;
+    dep3 -= dep2;
+    QVERIFY(dep3.neadedLibs() == QSet<QString>({"/depmap/libA.so"}));
+    QVERIFY(dep3.systemLibs() == QSet<QString>({"/depmap/libSys.so"}));
+
+    dep3 += dep2;
+    QVERIFY(dep3.neadedLibs() == QSet<QString>({"/depmap/libA.so",
+                                                "/depmap/libB.so",
+                                                "/depmap/libC.so"}));
+
+    dep3.removeNeadedLib("/depmap/libB.so");
+    dep3.removeSystemLib("/depmap/libSys.so");
+    QVERIFY(!dep3.containsNeadedLib("/depmap/libB.so"));
+    QVERIFY(dep3.systemLibs().isEmpty());
 }
 
 void deploytest::testQmlExtrct() {
@@ -1571,6 +1659,26 @@ void deploytest::testClear() {
 
     runTestParams({"clear"}, &compareTree);
 
+    // the force clear removes the trash dirs left by the interrupted deploys.
+    QDir("./forceClear").removeRecursively();
+    QVERIFY(QDir().mkpath("./forceClear/distro/bin"));
+    QVERIFY(QDir().mkpath("./forceClear/.distro.old-1-2/bin"));
+    StatCache::clear();
+
+    {
+        FileManager fileManager;
+        fileManager.clear(QFileInfo("./forceClear/distro").absoluteFilePath(), true);
+
+        QVERIFY(fileManager.getDeployedFiles().isEmpty());
+    }
+
+    // the trash dir of the force clear is removed too.
+    QVERIFY(QDir("./forceClear").entryList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot).
+            filter(".old-").isEmpty());
+    QVERIFY(!QFileInfo::exists("./forceClear/distro/bin"));
+
+    QDir("./forceClear").removeRecursively();
+    StatCache::clear();
 }
 
 void deploytest::testIgnore() {
@@ -2219,6 +2327,1362 @@ void deploytest::testOutDirs() {
 
 }
 
+void deploytest::testLdSoCache() {
+    QDir("./ldcache").removeRecursively();
+    QVERIFY(QDir().mkpath("./ldcache/lib/x86_64"));
+    QVERIFY(QDir().mkpath("./ldcache/conf.d"));
+
+    auto libDir = QFileInfo("./ldcache/lib/x86_64").absoluteFilePath();
+    QByteArray strings = "libtest.so.1";
+    strings.append('\0');
+    strings.append(libDir.toUtf8() + "/libtest.so.1");
+    strings.append('\0');
+
+    // new format: header (48 bytes), entry (24 bytes), strings
+    QByteArray cache("glibc-ld.so.cache1.1", 20);
+    quint32 nlibs = 1;
+    quint32 stringsSize = static_cast<quint32>(strings.size());
+    cache.append(reinterpret_cast<const char*>(&nlibs), 4);
+    cache.append(reinterpret_cast<const char*>(&stringsSize), 4);
+    cache.append(QByteArray(20, 0));
+
+    quint32 flags = 0x0303;
+    quint32 key = 48 + 24;
+    quint32 value = key + static_cast<quint32>(qstrlen("libtest.so.1")) + 1;
+    cache.append(reinterpret_cast<const char*>(&flags), 4);
+    cache.append(reinterpret_cast<const char*>(&key), 4);
+    cache.append(reinterpret_cast<const char*>(&value), 4);
+    cache.append(QByteArray(12, 0));
+    cache.append(strings);
+
+    QFile file("./ldcache/ld.so.cache");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(cache);
+    file.close();
+
+    file.setFileName("./ldcache/ld.so.conf");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("include conf.d/*.conf\n");
+    file.close();
+
+    file.setFileName("./ldcache/conf.d/test.conf");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("# comment\n" + QFileInfo("./ldcache/conf.d").absoluteFilePath().toUtf8() + "\n");
+    file.close();
+
+    LdSoCache ldCache;
+    QVERIFY(ldCache.isEmpty());
+    QVERIFY(ldCache.load("./ldcache/ld.so.cache"));
+    QVERIFY(ldCache.libraries("libtest.so.1") == QStringList{libDir + "/libtest.so.1"});
+    QVERIFY(ldCache.libraries("libother.so").isEmpty());
+
+    QVERIFY(ldCache.loadConfig("./ldcache/ld.so.conf"));
+    QVERIFY(ldCache.dirs().contains(libDir));
+    QVERIFY(ldCache.dirs().contains(QFileInfo("./ldcache/conf.d").absoluteFilePath()));
+
+    QVERIFY(!LdSoCache().load("./ldcache/ld.so.conf"));
+
+    QDir("./ldcache").removeRecursively();
+}
+
+void deploytest::testBinarySniffer() {
+
+    // elf 64 bit little endian, ET_DYN, one program header (PT_LOAD or PT_INTERP)
+    auto createElf = [](quint32 programType) {
+        QByteArray elf(4096, 0);
+        elf[0] = 0x7f; elf[1] = 'E'; elf[2] = 'L'; elf[3] = 'F';
+        elf[4] = 2; elf[5] = 1;
+        elf[16] = 3;
+        elf[32] = 64; // e_phoff
+        elf[54] = 56; // e_phentsize
+        elf[56] = 1; // e_phnum
+        elf[64] = static_cast<char>(programType);
+        return elf;
+    };
+
+    auto lib = BinarySniffer::sniffData(createElf(1), "libtest.so");
+    QVERIFY(lib.format == BinaryInfo::ELF);
+    QVERIFY(lib.platform == Unix64);
+    QVERIFY(lib.isLib);
+
+    auto pie = BinarySniffer::sniffData(createElf(3), "test");
+    QVERIFY(pie.format == BinaryInfo::ELF);
+    QVERIFY(pie.isExecutable());
+
+    QVERIFY(BinarySniffer::sniffData(createElf(3), "libc.so.6").isLib);
+
+    // pe 32 bit dll
+    QByteArray pe(4096, 0);
+    pe[0] = 'M'; pe[1] = 'Z';
+    pe[0x3c] = static_cast<char>(0x80);
+    pe[0x80] = 'P'; pe[0x81] = 'E';
+    pe[0x80 + 23] = 0x20; // characteristics: dll
+    pe[0x80 + 24] = 0x0B; pe[0x80 + 25] = 0x01; // optional header magic PE32
+
+    auto dll = BinarySniffer::sniffData(pe);
+    QVERIFY(dll.format == BinaryInfo::PE);
+    QVERIFY(dll.platform == Win32);
+    QVERIFY(dll.isLib);
+
+    pe[0x80 + 23] = 0;
+    QVERIFY(BinarySniffer::sniffData(pe).isExecutable());
+
+    QVERIFY(!BinarySniffer::sniffData("{\"json\": true}").isBinary());
+    QVERIFY(!BinarySniffer::sniffData("#!/bin/sh\necho test").isBinary());
+    QVERIFY(!BinarySniffer::sniff("./notExistsFile.so").isBinary());
+}
+
+void deploytest::testDirWalker() {
+    QDir("./walker").removeRecursively();
+
+    QVERIFY(QDir().mkpath("./walker/a/b"));
+    QVERIFY(QDir().mkpath("./walker/.hidden"));
+
+    auto touch = [](const QString& path) {
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly);
+    };
+
+    QVERIFY(touch("./walker/top"));
+    QVERIFY(touch("./walker/a/x.so"));
+    QVERIFY(touch("./walker/a/b/c.txt"));
+    QVERIFY(touch("./walker/.hidden/h"));
+
+    auto root = QFileInfo("./walker").absoluteFilePath();
+
+#ifdef Q_OS_UNIX
+    // the loop of the symlinks must be skipped.
+    QVERIFY(QFile::link(root + "/a", root + "/a/b/loop"));
+#endif
+
+    QStringList files = {root + "/a/b/c.txt", root + "/a/x.so", root + "/top"};
+    QVERIFY(DirWalker::paths(root, DirWalker::Files | DirWalker::FollowSymlinks) == files);
+    QVERIFY(DirWalker::paths(root, DirWalker::Files | DirWalker::Parallel) == files);
+    QVERIFY(DirWalker::paths(root, DirWalker::Files, 0) == QStringList{root + "/top"});
+
+    QStringList dirs = {root + "/a", root + "/a/b"};
+#ifdef Q_OS_UNIX
+    dirs.push_back(root + "/a/b/loop");
+#endif
+    QVERIFY(DirWalker::paths(root, DirWalker::Dirs | DirWalker::FollowSymlinks) == dirs);
+
+    auto hidden = DirWalker::walk(root, DirWalker::Files | DirWalker::Hidden, 1);
+    QVERIFY(hidden.size() == 3);
+    QVERIFY(hidden.first().relativePath() == ".hidden/h");
+    QVERIFY(hidden.first().fileName() == "h");
+    QVERIFY(hidden.first().dirPath() == root + "/.hidden");
+
+    QVERIFY(DirWalker::walk("./notExistsDir", DirWalker::AllEntries).isEmpty());
+
+    QDir("./walker").removeRecursively();
+}
+
+void deploytest::testStatCache() {
+    StatCache::clear();
+    QDir("./statcache").removeRecursively();
+
+    QVERIFY(!StatCache::exists("./statcache/a/file"));
+    QVERIFY(!StatCache::isDir("./statcache/a"));
+
+    QVERIFY(QDir().mkpath("./statcache/a"));
+    QFile file("./statcache/a/file");
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("test");
+    file.close();
+
+    // the cache is not changed without the invalidation.
+    QVERIFY(!StatCache::exists("./statcache/a/file"));
+    QVERIFY(!StatCache::isDir("./statcache/a"));
+
+    StatCache::invalidate("./statcache/a/file");
+    QVERIFY(StatCache::isFile("./statcache/a/file"));
+    QVERIFY(StatCache::stat(QFileInfo("./statcache/a/file").absoluteFilePath()).size == 4);
+    QVERIFY(StatCache::isDir("./statcache/a"));
+
+    QVERIFY(QDir("./statcache").removeRecursively());
+    QVERIFY(StatCache::isFile("./statcache/a/file"));
+
+    StatCache::invalidateTree("./statcache");
+    QVERIFY(!StatCache::exists("./statcache/a/file"));
+    QVERIFY(!StatCache::exists("./statcache/a"));
+
+    StatCache::clear();
+}
+
+void deploytest::testExtractTranslation() {
+    QSet<QString> libs = {
+        "/opt/Qt/5.15.0/gcc_64/lib/libQt5Core.so.5",
+        "libQt5Quick.so.5.15.0",
+        "C:/Qt/5.15.0/msvc2019_64/bin/Qt5Multimediad.dll",
+        "C:\\Qt\\5.15.0\\msvc2019_64\\bin\\Qt5Help.dll",
+        "/usr/lib/libQt5QuickControls2.so.5",
+        "/usr/lib/libstdc++.so.6"
+    };
+
+    auto translations = DeployCore::extractTranslation(libs);
+    translations.sort();
+
+    QVERIFY(translations == QStringList({"qt_help", "qtbase", "qtdeclarative", "qtmultimedia"}));
+}
+
+void deploytest::testDeployManifest() {
+    // the manifests of the test are saved into the test dir of the app data.
+    QStandardPaths::setTestModeEnabled(true);
+
+    auto targetDir = QFileInfo("./manifestTest").absoluteFilePath();
+
+    ManifestEntry lib;
+    lib.path = targetDir + "/lib/libTest.so";
+    lib.size = 100;
+    lib.modified = 200;
+    lib.sourceHash = DeployManifest::sourceHash("/src/libTest.so", 100, 150);
+
+    ManifestEntry dir;
+    dir.path = targetDir + "/lib";
+
+    QVERIFY(DeployManifest::save(targetDir, {lib, dir}, "fingerprint", {"/qt/lib", "/qt/bin"}));
+
+    DeployManifest manifest;
+    QVERIFY(manifest.open(targetDir));
+
+    QVERIFY(manifest.fingerprint() == "fingerprint");
+    QVERIFY(manifest.fingerprintDirs() == QStringList({"/qt/lib", "/qt/bin"}));
+    QVERIFY(manifest.targetDir() == targetDir);
+    QVERIFY(manifest.paths() == QStringList({dir.path, lib.path}));
+
+    ManifestEntry entry;
+    QVERIFY(manifest.find(lib.path, entry));
+    QVERIFY(entry.size == lib.size);
+    QVERIFY(entry.modified == lib.modified);
+    QVERIFY(entry.sourceHash == lib.sourceHash);
+    QVERIFY(entry.sourceHash != DeployManifest::sourceHash("/src/libTest.so", 100, 151));
+    QVERIFY(!manifest.find(targetDir + "/lib/libOther.so", entry));
+
+    manifest.close();
+    QVERIFY(DeployManifest::remove(targetDir));
+    QVERIFY(!manifest.open(targetDir));
+    QVERIFY(DeployManifest::remove(targetDir));
+
+    // the manifests of the removed target dirs and the invalid manifests are swept.
+    QDir(targetDir).removeRecursively();
+    QVERIFY(QDir().mkpath(targetDir));
+    auto removedDir = QFileInfo("./manifestTestRemoved").absoluteFilePath();
+    QDir(removedDir).removeRecursively();
+
+    QVERIFY(DeployManifest::save(targetDir, {lib}));
+    QVERIFY(DeployManifest::save(removedDir, {lib}));
+
+    auto invalid = QFileInfo(DeployManifest::location(targetDir)).absolutePath() + "/invalidManifest";
+    QFile invalidFile(invalid);
+    QVERIFY(invalidFile.open(QIODevice::WriteOnly));
+    invalidFile.write("not a manifest");
+    invalidFile.close();
+
+    QVERIFY(DeployManifest::removeOutdated() >= 2);
+    QVERIFY(QFile::exists(DeployManifest::location(targetDir)));
+    QVERIFY(!QFile::exists(DeployManifest::location(removedDir)));
+    QVERIFY(!QFile::exists(invalid));
+
+    // the force clear removes the manifest of the target dir.
+    {
+        FileManager file;
+        file.loadDeployemendFiles(targetDir);
+        file.clear(targetDir, true);
+    }
+
+    QVERIFY(!QFile::exists(DeployManifest::location(targetDir)));
+    QVERIFY(!QFileInfo::exists(targetDir));
+
+    QStandardPaths::setTestModeEnabled(false);
+}
+
+void deploytest::testEnvirementLookup() {
+    StatCache::clear();
+    QDir("./envLookup").removeRecursively();
+
+    QVERIFY(QDir().mkpath("./envLookup/first"));
+    QVERIFY(QDir().mkpath("./envLookup/second"));
+
+    for (const auto &file : {"./envLookup/first/libEnvTest.so.1",
+                             "./envLookup/second/libEnvTest.so.1",
+                             "./envLookup/second/EnvTest.dll"}) {
+        QFile lib(file);
+        QVERIFY(lib.open(QIODevice::WriteOnly));
+        lib.close();
+    }
+
+    DependenciesScanner scaner;
+    scaner.setEnvironment({QFileInfo("./envLookup/first").absoluteFilePath(),
+                           QFileInfo("./envLookup/second").absoluteFilePath(),
+                           QFileInfo("./envLookup/notExists").absoluteFilePath()});
+
+    QVERIFY(scaner._envLookup.isEmpty());
+
+    auto found = scaner.findInEnvirement("libEnvTest.so.1");
+    QVERIFY(found == QStringList({QFileInfo("./envLookup/first/libEnvTest.so.1").absoluteFilePath(),
+                                  QFileInfo("./envLookup/second/libEnvTest.so.1").absoluteFilePath()}));
+
+    found = scaner.findInEnvirement("ENVTEST.DLL");
+    QVERIFY(found == QStringList({QFileInfo("./envLookup/second/EnvTest.dll").absoluteFilePath()}));
+
+    QVERIFY(scaner.findInEnvirement("libNotExists.so").isEmpty());
+    QVERIFY(scaner._envLookup.size() == 3);
+
+    QDir("./envLookup").removeRecursively();
+    StatCache::clear();
+}
+
+void deploytest::testBatchDeploy() {
+    TestUtils utils;
+    QDir("./batchTest").removeRecursively();
+    QVERIFY(QDir().mkpath("./batchTest"));
+
+    auto fullTarget = QFileInfo("./batchTest/full").absoluteFilePath();
+    auto ignoreTarget = QFileInfo("./batchTest/ignore").absoluteFilePath();
+
+#ifdef Q_OS_UNIX
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+    auto comapareTree = utils.createTree(
+    {
+                    ignoreTarget + "/QtWidgetsProject.sh",
+                    ignoreTarget + "/bin/qt.conf",
+                    ignoreTarget + "/bin/QtWidgetsProject",
+                });
+#else
+    QString bin = TestBinDir + "QtWidgetsProject.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+    auto comapareTree = utils.createTree(
+    {
+                    ignoreTarget + "/qt.conf",
+                    ignoreTarget + "/QtWidgetsProject.exe",
+                });
+
+    if (!TestQtDir.contains("Qt5")) {
+        comapareTree += utils.createTree(
+        {
+            ignoreTarget + "/libgcc_s_seh-1.dll",
+            ignoreTarget + "/libstdc++-6.dll",
+            ignoreTarget + "/libwinpthread-1.dll"
+        });
+    }
+#endif
+
+    auto writeConf = [](const QString& path, const QJsonObject& obj) {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        file.write(QJsonDocument(obj).toJson());
+        file.close();
+        return true;
+    };
+
+    auto fullConf = QFileInfo("./batchTest/full.json").absoluteFilePath();
+    auto ignoreConf = QFileInfo("./batchTest/ignore.json").absoluteFilePath();
+
+    QVERIFY(writeConf(fullConf, {{"bin", bin},
+                                 {"qmake", qmake},
+                                 {"targetDir", fullTarget},
+                                 {"clear", true}}));
+
+    QVERIFY(writeConf(ignoreConf, {{"bin", bin},
+                                   {"qmake", qmake},
+                                   {"targetDir", ignoreTarget},
+                                   {"ignore", "Qt5"},
+                                   {"clear", true}}));
+
+    // the both configurations use the one scaner,
+    // so the libraries scaned for the first configuration must not leak into the second.
+    DependenciesScanner scaner;
+    QStringList args = {"-confFile", fullConf + "," + ignoreConf};
+
+    QVERIFY(QuasarAppUtils::Params::parseParams(args));
+    QVERIFY(BatchDeploy::isBatch());
+
+    BatchDeploy batch(&scaner);
+    QVERIFY(batch.run(args) == Good);
+
+    auto fullTree = utils.getTree(fullTarget);
+    QVERIFY(fullTree.size() > comapareTree.size());
+
+    auto comapre = utils.compareTree(utils.getTree(ignoreTarget), comapareTree);
+    if (comapre.size()) {
+        for (auto i = comapre.begin(); i != comapre.end(); ++i) {
+            qCritical() << i.key() << i.value();
+        }
+        QVERIFY(false);
+    }
+
+    QDir("./batchTest").removeRecursively();
+}
+
+void deploytest::testDeployServer() {
+    TestUtils utils;
+    auto targetDir = QFileInfo("./" + DISTRO_DIR).absoluteFilePath();
+
+#ifdef Q_OS_UNIX
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+    auto comapareTree = utils.createTree(
+    {
+                    "./" + DISTRO_DIR + "/QtWidgetsProject.sh",
+                    "./" + DISTRO_DIR + "/bin/qt.conf",
+                    "./" + DISTRO_DIR + "/bin/QtWidgetsProject",
+                });
+#else
+    QString bin = TestBinDir + "QtWidgetsProject.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+    auto comapareTree = utils.createTree(
+    {
+                    "./" + DISTRO_DIR + "/qt.conf",
+                    "./" + DISTRO_DIR + "/QtWidgetsProject.exe",
+                });
+
+    if (!TestQtDir.contains("Qt5")) {
+        comapareTree += utils.createTree(
+        {
+            "./" + DISTRO_DIR + "/libgcc_s_seh-1.dll",
+            "./" + DISTRO_DIR + "/libstdc++-6.dll",
+            "./" + DISTRO_DIR + "/libwinpthread-1.dll"
+        });
+    }
+#endif
+
+    // the server is started without the targetDir, so the requests can deploy only into the current dir.
+    QuasarAppUtils::Params::parseParams({"server"});
+    DeployServer server;
+    QVERIFY(server._allowedTargetDirs == QStringList{QDir::currentPath()});
+
+    QStringList fullArgs = {"-bin", bin, "clear", "-qmake", qmake};
+
+    // the first request fills the cache of the scaned libraries of the server.
+    QVERIFY(server.runRequest(QDir::currentPath(), fullArgs) == Good);
+    auto fullTree = utils.getTree(targetDir);
+    QVERIFY(fullTree.size() > comapareTree.size());
+
+    // the request with the other ignore list must not reuse the cached libraries.
+    QVERIFY(server.runRequest(QDir::currentPath(), fullArgs + QStringList{"-ignore", "Qt5"}) == Good);
+
+    auto comapre = utils.compareTree(utils.getTree(targetDir), comapareTree);
+    if (comapre.size()) {
+        for (auto i = comapre.begin(); i != comapre.end(); ++i) {
+            qCritical() << i.key() << i.value();
+        }
+        QVERIFY(false);
+    }
+
+    // and the next request without the ignore list deploys all libraries again.
+    QVERIFY(server.runRequest(QDir::currentPath(), fullArgs) == Good);
+    QVERIFY(utils.getTree(targetDir) == fullTree);
+
+    QVERIFY(server.runRequest(QDir::currentPath(), {"clear"}) == Good);
+
+    // the request with the target dir outside of the dirs of the server is rejected before the deploy.
+    auto outside = QFileInfo(QDir::currentPath() + "/../serverOutside").absoluteFilePath();
+    QDir(outside).removeRecursively();
+
+    QVERIFY(server.runRequest(QDir::currentPath(), fullArgs + QStringList{"-targetDir", outside}) == PrepareError);
+    QVERIFY(!QFileInfo::exists(outside));
+
+    // the sibling dir with the same prefix is outside too.
+    auto sibling = QDir::currentPath() + "Sibling";
+    QVERIFY(server.runRequest(QDir::currentPath(), fullArgs + QStringList{"-targetDir", sibling}) == PrepareError);
+    QVERIFY(!QFileInfo::exists(sibling));
+}
+
+void deploytest::testPEImports() {
+
+    // one section (.idata) with the import and the delay import directories.
+    // section: rva 0x1000, file offset 0x200, size 0x200.
+    auto createPE = [](bool pe64, quint32 importRva, quint32 delayImportRva) {
+        QByteArray pe(0x400, 0);
+        auto data = reinterpret_cast<uchar*>(pe.data());
+
+        qToLittleEndian<quint16>(0x5A4D, data); // MZ
+        qToLittleEndian<quint32>(0x40, data + 0x3C);
+        qToLittleEndian<quint32>(0x00004550, data + 0x40); // PE\0\0
+
+        quint16 optionalHeaderSize = (pe64)? 240: 224;
+        qToLittleEndian<quint16>(1, data + 0x44 + 2);
+        qToLittleEndian<quint16>(optionalHeaderSize, data + 0x44 + 16);
+
+        auto optionalHeader = data + 0x58;
+        qToLittleEndian<quint16>((pe64)? 0x20B: 0x10B, optionalHeader);
+
+        auto directories = optionalHeader + ((pe64)? 112: 96);
+        qToLittleEndian<quint32>(16, directories - 4);
+        qToLittleEndian<quint32>(importRva, directories + 1 * 8);
+        qToLittleEndian<quint32>(delayImportRva, directories + 13 * 8);
+
+        auto section = optionalHeader + optionalHeaderSize;
+        memcpy(section, ".idata", 6);
+        qToLittleEndian<quint32>(0x200, section + 8);
+        qToLittleEndian<quint32>(0x1000, section + 12);
+        qToLittleEndian<quint32>(0x200, section + 16);
+        qToLittleEndian<quint32>(0x200, section + 20);
+
+        auto sectionData = data + 0x200;
+
+        // import descriptors (rva 0x1000), the last descriptor is empty.
+        qToLittleEndian<quint32>(0x1100, sectionData + 12);
+        qToLittleEndian<quint32>(0x1120, sectionData + 20 + 12);
+
+        // delay import descriptor (rva 0x1080), attributes: the rva based.
+        qToLittleEndian<quint32>(1, sectionData + 0x80);
+        qToLittleEndian<quint32>(0x1140, sectionData + 0x80 + 4);
+
+        memcpy(sectionData + 0x100, "Qt5Core.dll", 11);
+        memcpy(sectionData + 0x120, "KERNEL32.dll", 12);
+        memcpy(sectionData + 0x140, "Qt5Network.dll", 14);
+
+        return pe;
+    };
+
+    auto readImports = [](const QByteArray& data, PE::RunType &type, PE::Imports &imports) {
+        // the copy has the exact size, so the reading past the end is visible for the sanitizers.
+        QScopedArrayPointer<uchar> mapping(new uchar[static_cast<size_t>(data.size())]);
+        memcpy(mapping.data(), data.constData(), static_cast<size_t>(data.size()));
+
+        imports = {};
+        return PE().readImports(mapping.data(), data.size(), type, imports);
+    };
+
+    PE::RunType type;
+    PE::Imports imports;
+
+    QVERIFY(readImports(createPE(false, 0x1000, 0x1080), type, imports));
+    QVERIFY(type == PE::RunType::_32bit);
+    QVERIFY(imports.imports == QStringList({"Qt5Core.dll", "KERNEL32.dll"}));
+    QVERIFY(imports.delayImports == QStringList({"Qt5Network.dll"}));
+
+    QVERIFY(readImports(createPE(true, 0x1000, 0x1080), type, imports));
+    QVERIFY(type == PE::RunType::_64bit);
+    QVERIFY(imports.imports == QStringList({"Qt5Core.dll", "KERNEL32.dll"}));
+    QVERIFY(imports.delayImports == QStringList({"Qt5Network.dll"}));
+
+    // without the delay import directory.
+    QVERIFY(readImports(createPE(true, 0x1000, 0), type, imports));
+    QVERIFY(imports.imports == QStringList({"Qt5Core.dll", "KERNEL32.dll"}));
+    QVERIFY(imports.delayImports.isEmpty());
+
+    // the directories out of the sections.
+    QVERIFY(readImports(createPE(false, 0x9000, 0xFFFFFFF0), type, imports));
+    QVERIFY(imports.imports.isEmpty());
+    QVERIFY(imports.delayImports.isEmpty());
+
+    // the name of the module out of the sections.
+    auto pe = createPE(false, 0x1000, 0);
+    qToLittleEndian<quint32>(0x7000, reinterpret_cast<uchar*>(pe.data()) + 0x200 + 12);
+    QVERIFY(readImports(pe, type, imports));
+    QVERIFY(imports.imports == QStringList({"KERNEL32.dll"}));
+
+    // the file truncated inside the section data.
+    QVERIFY(readImports(createPE(false, 0x1000, 0x1080).left(0x300), type, imports));
+    QVERIFY(imports.imports.isEmpty());
+    QVERIFY(imports.delayImports.isEmpty());
+
+    QVERIFY(readImports(createPE(true, 0x1000, 0x1080).left(0x20A), type, imports));
+    QVERIFY(imports.imports.isEmpty());
+
+    // the file truncated inside the headers.
+    QVERIFY(!readImports(createPE(false, 0x1000, 0x1080).left(0x50), type, imports));
+    QVERIFY(!readImports(createPE(true, 0x1000, 0x1080).left(0x100), type, imports));
+    QVERIFY(!readImports(createPE(false, 0x1000, 0x1080).left(0x3C), type, imports));
+
+    // the not pe files.
+    QVERIFY(!readImports(QByteArray(0x400, 0), type, imports));
+
+    QVector<PE::Section> sections(1);
+    sections[0].virtualAddress = 0x1000;
+    sections[0].virtualSize = 0x300;
+    sections[0].rawSize = 0x200;
+    sections[0].rawOffset = 0x400;
+
+    QVERIFY(PE::rvaToOffset(sections, 0x1000) == 0x400);
+    QVERIFY(PE::rvaToOffset(sections, 0x11FF) == 0x5FF);
+    QVERIFY(PE::rvaToOffset(sections, 0x10) == 0x10);
+
+    // the uninitialized data of the section and the rva out of the sections.
+    QVERIFY(PE::rvaToOffset(sections, 0x1200) == -1);
+    QVERIFY(PE::rvaToOffset(sections, 0x1300) == -1);
+    QVERIFY(PE::rvaToOffset(sections, 0xFFFFFFFF) == -1);
+    QVERIFY(PE::rvaToOffset({}, 0x10) == -1);
+}
+
+void deploytest::testSetRunPath() {
+#ifdef Q_OS_UNIX
+    QDir("./runPathTest").removeRecursively();
+    QVERIFY(QDir().mkpath("./runPathTest"));
+
+    auto bin = QFileInfo("./runPathTest/QtWidgetsProject").absoluteFilePath();
+    QVERIFY(QFile::copy(TestBinDir + "QtWidgetsProject", bin));
+    QVERIFY(QFile::setPermissions(bin, QFile::permissions(bin) | QFile::WriteOwner));
+    StatCache::invalidate(bin);
+
+    ELF elf;
+    auto oldRunPath = elf.getRunPath(bin).join(':');
+    if (oldRunPath.size() < 7) {
+        QDir("./runPathTest").removeRecursively();
+        QSKIP("The test binary does not have the run path long enough for the test.");
+    }
+
+    LibInfo oldInfo;
+    QVERIFY(elf.getLibInfo(bin, oldInfo));
+
+    // the string table is not resized, so the run path can be rewritten up to the size of the existing string.
+    QByteArray fullSize(oldRunPath.size(), 'a');
+    QVERIFY(elf.setRunPath(bin, fullSize));
+    QVERIFY(elf.getRunPath(bin) == QStringList({QString(fullSize)}));
+
+    QVERIFY(!elf.setRunPath(bin, QByteArray(oldRunPath.size() + 1, 'b')));
+    QVERIFY(elf.getRunPath(bin) == QStringList({QString(fullSize)}));
+
+    QVERIFY(elf.setRunPath(bin, "$ORIGIN"));
+    QVERIFY(elf.getRunPath(bin) == QStringList({"$ORIGIN"}));
+
+    // the rest of the old string is filled by zeros, so the existing string is short now.
+    QVERIFY(!elf.setRunPath(bin, "$ORIGIN/lib"));
+    QVERIFY(elf.getRunPath(bin) == QStringList({"$ORIGIN"}));
+
+    // the other data of the binary is not changed.
+    LibInfo info;
+    QVERIFY(elf.getLibInfo(bin, info));
+    QVERIFY(info.getDependncies() == oldInfo.getDependncies());
+
+    QDir("./runPathTest").removeRecursively();
+#endif
+}
+
+void deploytest::testWatch() {
+#ifdef Q_OS_UNIX
+    QString bin = "QtWidgetsProject";
+    QString otherBin = "TestOnlyC";
+    QString qmake = TestQtDir + "bin/qmake";
+#else
+    QString bin = "QtWidgetsProject.exe";
+    QString otherBin = "TestOnlyC.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+#endif
+
+    QDir("./watchTest").removeRecursively();
+    QVERIFY(QDir().mkpath("./watchTest/src"));
+
+    auto source = QFileInfo("./watchTest/src/" + bin).absoluteFilePath();
+    auto targetDir = QFileInfo("./watchTest/distro").absoluteFilePath();
+    QVERIFY(QFile::copy(TestBinDir + bin, source));
+
+    QuasarAppUtils::Params::parseParams({"-bin", source, "clear",
+                                         "-qmake", qmake,
+                                         "-targetDir", targetDir,
+                                         "-ignore", "Qt5",
+                                         "patchRunPath"});
+
+    Deploy deploy;
+    QVERIFY(deploy.run() == Good);
+
+    // the watcher is driven without the event loop, the changes are passed directly.
+    DeployWatcher watcher(deploy._extracter, deploy._fileManager, targetDir);
+
+    auto deployed = DeployCore::_config->getTargetDir() +
+            DeployCore::_config->getDistroFromPackage("").getBinOutDir() + bin;
+    QVERIFY(QFileInfo(deployed).size() == QFileInfo(source).size());
+
+#ifdef Q_OS_UNIX
+    ELF elf;
+    auto runPath = elf.getRunPath(deployed);
+
+    // the run scripts are created again by the redeploy.
+    auto script = targetDir + "/" + bin + ".sh";
+    QVERIFY(QFile::remove(script));
+#endif
+
+    // the rebuild of the binary is redeployed.
+    QVERIFY(QFile::remove(source));
+    QVERIFY(QFile::copy(TestBinDir + otherBin, source));
+
+    watcher._changed.insert(source);
+    watcher.handleTimeout();
+
+    QVERIFY(watcher._changed.isEmpty());
+    QVERIFY(QFileInfo(deployed).size() == QFileInfo(source).size());
+
+#ifdef Q_OS_UNIX
+    QVERIFY(QFileInfo::exists(script));
+
+    // the run path of the new binary is patched like in the full deploy (if the new binary has the space for it).
+    if (runPath.size() && elf.getRunPath(source).join(':').size() >= runPath.join(':').size()) {
+        QVERIFY(elf.getRunPath(deployed) == runPath);
+    }
+#endif
+
+    // the removed binary is waited for the limited count of the checks.
+    QVERIFY(QFile::remove(source));
+
+    watcher._changed.insert(source);
+    for (int i = 0; i < WATCH_MAX_RETRIES; ++i) {
+        watcher.handleTimeout();
+        QVERIFY(watcher._changed.contains(source));
+    }
+
+    watcher.handleTimeout();
+    QVERIFY(watcher._changed.isEmpty());
+    QVERIFY(watcher._retries.isEmpty());
+    QVERIFY(QFileInfo::exists(deployed));
+
+    // the path is dropped at once if the dir of the path is removed too.
+    watcher._changed.insert(QFileInfo("./watchTest/removed/" + bin).absoluteFilePath());
+    watcher.handleTimeout();
+    QVERIFY(watcher._changed.isEmpty());
+
+    QDir("./watchTest").removeRecursively();
+}
+
+void deploytest::testPruneUnusedLibs() {
+#ifdef Q_OS_UNIX
+    TestUtils utils;
+
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+
+    auto widgetsList = QDir(TestQtDir + "lib").entryInfoList({"libQt5Widgets.so.5"}, QDir::Files);
+    if (widgetsList.isEmpty()) {
+        QSKIP("The Qt of the tests does not have the libQt5Widgets library.");
+    }
+
+    // the symbols of the Qt are used only by the QtWidgetsProject.
+    DependenciesScanner scaner;
+    scaner._pruneMode = true;
+
+    LibInfo widgets, widgetsProject, onlyC;
+    QVERIFY(scaner.fillLibInfo(widgets, widgetsList.first().absoluteFilePath()));
+    QVERIFY(scaner.fillLibInfo(widgetsProject, bin));
+    QVERIFY(scaner.fillLibInfo(onlyC, TestBinDir + "TestOnlyC"));
+
+    QVERIFY(!scaner.isUnused(widgetsProject, widgets));
+    QVERIFY(scaner.isUnused(onlyC, widgets));
+
+    scaner._pruneMode = false;
+    QVERIFY(!scaner.isUnused(onlyC, widgets));
+
+    // the pruned library is removed from the DT_NEEDED entries of the deployed copy.
+    QDir("./removeNeeded").removeRecursively();
+    QVERIFY(QDir().mkpath("./removeNeeded"));
+    auto copy = QFileInfo("./removeNeeded/QtWidgetsProject").absoluteFilePath();
+    QVERIFY(QFile::copy(bin, copy));
+    QVERIFY(QFile::setPermissions(copy, QFile::permissions(copy) | QFile::WriteOwner));
+
+    ELF elf;
+    auto runPath = elf.getRunPath(copy);
+    auto needed = widgetsProject.getDependncies();
+    QVERIFY(needed.contains(widgets.getName().toUpper()));
+
+    QVERIFY(elf.removeNeeded(copy, {widgets.getName().toUtf8(), "libNotNeeded.so"}) == 1);
+    QVERIFY(elf.removeNeeded(copy, {widgets.getName().toUtf8()}) == 0);
+
+    LibInfo patched;
+    QVERIFY(scaner.fillLibInfo(patched, copy));
+    needed.remove(widgets.getName().toUpper());
+    QVERIFY(patched.getDependncies() == needed);
+    QVERIFY(elf.getRunPath(copy) == runPath);
+
+    QDir("./removeNeeded").removeRecursively();
+
+    // the full deploy.
+    QuasarAppUtils::Params::parseParams({"-bin", bin, "clear", "-qmake", qmake});
+
+    QSet<QString> fullTree;
+    {
+        Deploy deploy;
+        QVERIFY(deploy.run() == Good);
+        fullTree = utils.getTree(DeployCore::_config->getTargetDir());
+        QVERIFY(deploy._scaner->prunedLibs().isEmpty());
+    }
+
+    QuasarAppUtils::Params::parseParams({"-bin", bin, "clear", "-qmake", qmake, "pruneUnusedLibs"});
+
+    Deploy deploy;
+    QVERIFY(deploy.run() == Good);
+
+    auto targetDir = DeployCore::_config->getTargetDir();
+    auto prunedTree = utils.getTree(targetDir);
+    auto pruned = deploy._scaner->prunedLibs();
+
+    QSet<QString> prunedTreeNames;
+    for (const auto &file : prunedTree) {
+        prunedTreeNames.insert(QFileInfo(file).fileName());
+    }
+
+    // the libraries used by the binary are kept.
+    for (const auto &lib : {"libQt5Core.so", "libQt5Gui.so", "libQt5Widgets.so"}) {
+        QVERIFY2(prunedTreeNames.contains(lib), lib);
+    }
+
+    // the pruning only removes the libraries from the distribution.
+    QVERIFY((prunedTree - fullTree).isEmpty());
+
+    for (auto it = pruned.cbegin(); it != pruned.cend(); ++it) {
+        QVERIFY2(QFileInfo::exists(it.key()), qPrintable(it.key()));
+        QVERIFY(it.value() == QFileInfo(it.key()).size());
+    }
+
+    // the deployed binaries do not require the pruned libraries, so the bundle is self-contained.
+    Verifier verifier(deploy._scaner);
+    QVERIFY(verifier.verify());
+    QVERIFY(verifier._missing == 0);
+#endif
+}
+
+void deploytest::testSkipUnchanged() {
+    TestUtils utils;
+
+#ifdef Q_OS_UNIX
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+#else
+    QString bin = TestBinDir + "QtWidgetsProject.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+#endif
+
+    auto targetDir = QFileInfo("./skipUnchanged").absoluteFilePath();
+    QStringList args = {"-bin", bin, "-qmake", qmake, "-targetDir", targetDir, "skipUnchanged"};
+
+    auto isUnchanged = [](const QStringList& args) {
+        QuasarAppUtils::Params::parseParams(args);
+
+        Deploy deploy;
+        return deploy.isUnchanged();
+    };
+
+    QuasarAppUtils::Params::parseParams(args + QStringList{"force-clear"});
+    {
+        Deploy deploy;
+        QVERIFY(deploy.run() == Good);
+    }
+
+    // the force clear drops the fingerprint, so the first deploy without it is not skipped.
+    QVERIFY(!isUnchanged(args));
+
+    QuasarAppUtils::Params::parseParams(args);
+    {
+        Deploy deploy;
+        QVERIFY(deploy.run() == Good);
+    }
+
+    auto tree = utils.getTree(targetDir);
+    QVERIFY(tree.size());
+
+    QVERIFY(isUnchanged(args));
+
+    // the skipped deploy does not change the distribution.
+    QuasarAppUtils::Params::parseParams(args);
+    {
+        Deploy deploy;
+        QVERIFY(deploy.run() == Good);
+    }
+    QVERIFY(utils.getTree(targetDir) == tree);
+
+    // the other options, the clear flags and the watch mode disable the skip.
+    QVERIFY(!isUnchanged(args + QStringList{"-ignore", "Qt5"}));
+    QVERIFY(!isUnchanged(args + QStringList{"clear"}));
+    QVERIFY(!isUnchanged(args + QStringList{"watch"}));
+    QVERIFY(!isUnchanged(args + QStringList{"verify"}));
+    QVERIFY(!isUnchanged(args + QStringList{"noRecursiveiIgnoreEnv"}));
+
+    // the removed file of the distribution is deployed again.
+    QString removed;
+    for (const auto &file : tree) {
+        if (QFileInfo(file).fileName().contains("Qt5Core")) {
+            removed = file;
+            break;
+        }
+    }
+
+    if (removed.size()) {
+        for (const auto &file : QDir(QFileInfo(removed).absolutePath()).entryInfoList({"*Qt5Core*"}, QDir::Files)) {
+            QVERIFY(QFile::remove(file.absoluteFilePath()));
+        }
+
+        QVERIFY(!isUnchanged(args));
+
+        QuasarAppUtils::Params::parseParams(args);
+        {
+            Deploy deploy;
+            QVERIFY(deploy.run() == Good);
+        }
+
+        QVERIFY(utils.getTree(targetDir) == tree);
+        QVERIFY(isUnchanged(args));
+    }
+
+    QuasarAppUtils::Params::parseParams({"clear", "-targetDir", targetDir});
+    {
+        Deploy deploy;
+        QVERIFY(deploy.run() == Good);
+    }
+    QDir(targetDir).removeRecursively();
+
+    auto keys = DeployCore::helpKeys();
+    QVERIFY(keys.contains("noRecursiveiIgnoreEnv"));
+    QVERIFY(keys.contains("qmlOut"));
+
+    // the targets of the nested dirs of the binDir are the inputs too.
+    QDir("./skipUnchangedBinDir").removeRecursively();
+    QVERIFY(QDir().mkpath("./skipUnchangedBinDir/sub"));
+    auto nested = QFileInfo("./skipUnchangedBinDir/sub/" + QFileInfo(bin).fileName()).absoluteFilePath();
+    QVERIFY(QFile::copy(bin, nested));
+
+    QuasarAppUtils::Params::parseParams({"-binDir", QFileInfo("./skipUnchangedBinDir").absoluteFilePath()});
+    auto inputs = Fingerprint::inputs();
+    QVERIFY(inputs.size());
+
+    QFile nestedFile(nested);
+    QVERIFY(nestedFile.setPermissions(nestedFile.permissions() | QFile::WriteOwner));
+    QVERIFY(nestedFile.open(QIODevice::ReadWrite));
+    auto size = nestedFile.size();
+    // the same size and the modification time, only the content is changed.
+    auto time = nestedFile.fileTime(QFileDevice::FileModificationTime);
+    QVERIFY(nestedFile.seek(size - 1));
+    char last = 0;
+    QVERIFY(nestedFile.getChar(&last));
+    QVERIFY(nestedFile.seek(size - 1));
+    QVERIFY(nestedFile.putChar(last ^ 0x1));
+    QVERIFY(nestedFile.flush());
+    QVERIFY(nestedFile.setFileTime(time, QFileDevice::FileModificationTime));
+    nestedFile.close();
+
+    QVERIFY(Fingerprint::inputs() != inputs);
+
+    QDir("./skipUnchangedBinDir").removeRecursively();
+}
+
+void deploytest::testQmakeQuery() {
+    QDir("./qmakeQuery").removeRecursively();
+    QVERIFY(QDir().mkpath("./qmakeQuery/bin"));
+
+    FileManager file;
+    DependenciesScanner scan;
+    Packing pac;
+    ConfigParser parser(&file, &scan, &pac);
+
+    auto prefix = QFileInfo("./qmakeQuery").absoluteFilePath();
+    auto qmake = prefix + "/bin/qmake";
+
+#ifdef Q_OS_UNIX
+    // the fake qmake counts own runs.
+    auto writeQmake = [&qmake](const QString& libs, int secs) {
+        QFile script(qmake);
+        if (!script.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        script.write(QString("#!/bin/sh\n"
+                             "echo run >> \"$(dirname \"$0\")/runs\"\n"
+                             "echo \"QT_INSTALL_LIBS:%0\"\n").arg(libs).toUtf8());
+
+        if (!script.flush())
+            return false;
+
+        // the modification time is a part of the key of the cache.
+        return script.setFileTime(QDateTime::currentDateTime().addSecs(secs),
+                                  QFileDevice::FileModificationTime) &&
+                script.setPermissions(script.permissions() | QFile::ExeOwner);
+    };
+
+    auto runs = [&prefix]() {
+        QFile file(prefix + "/bin/runs");
+        if (!file.open(QIODevice::ReadOnly))
+            return 0;
+
+        return file.readAll().count('\n');
+    };
+
+    QVERIFY(writeQmake("/first/lib", 10));
+
+    QString result;
+    QVERIFY(parser.queryQmake(qmake, result));
+    QVERIFY(result.contains("QT_INSTALL_LIBS:/first/lib"));
+    QVERIFY(runs() == 1);
+
+    // the second query is readed from the cache.
+    result.clear();
+    QVERIFY(parser.queryQmake(qmake, result));
+    QVERIFY(result.contains("QT_INSTALL_LIBS:/first/lib"));
+    QVERIFY(runs() == 1);
+
+    // the changed qmake is queried again.
+    QVERIFY(writeQmake("/second/lib", 20));
+
+    QVERIFY(parser.queryQmake(qmake, result));
+    QVERIFY(result.contains("QT_INSTALL_LIBS:/second/lib"));
+    QVERIFY(runs() == 2);
+#endif
+
+    // the qt.conf is a part of the key of the cache too and it is readed by the noRunQmake mode.
+    QSettings qtConf(prefix + "/bin/qt.conf", QSettings::IniFormat);
+    qtConf.beginGroup("Paths");
+    qtConf.setValue("Prefix", "..");
+    qtConf.setValue("Libraries", "lib64");
+    qtConf.setValue("Plugins", "/opt/plugins");
+    qtConf.endGroup();
+    qtConf.sync();
+
+#ifdef Q_OS_UNIX
+    QVERIFY(parser.queryQmake(qmake, result));
+    QVERIFY(runs() == 3);
+#endif
+
+    auto lines = parser.readQtConf(qmake).split('\n');
+    QVERIFY(lines.contains("QT_INSTALL_PREFIX:" + prefix));
+    QVERIFY(lines.contains("QT_INSTALL_LIBS:" + prefix + "/lib64"));
+    QVERIFY(lines.contains("QT_INSTALL_BINS:" + prefix + "/bin"));
+    QVERIFY(lines.contains("QT_INSTALL_PLUGINS:/opt/plugins"));
+    QVERIFY(lines.contains("QT_INSTALL_QML:" + prefix + "/qml"));
+    QVERIFY(lines.contains("QT_INSTALL_TRANSLATIONS:" + prefix + "/translations"));
+
+    QDir("./qmakeQuery").removeRecursively();
+}
+
+void deploytest::testBinDirDiscovery() {
+#ifdef Q_OS_UNIX
+    QString rootBin = "QtWidgetsProject";
+    QString nestedBin = "TestOnlyC";
+#else
+    QString rootBin = "QtWidgetsProject.exe";
+    QString nestedBin = "TestOnlyC.exe";
+#endif
+
+    QDir("./binDirDiscovery").removeRecursively();
+    QVERIFY(QDir().mkpath("./binDirDiscovery/sub/dir"));
+
+    auto dir = QFileInfo("./binDirDiscovery").absoluteFilePath();
+    QVERIFY(QFile::copy(TestBinDir + rootBin, dir + "/" + rootBin));
+    QVERIFY(QFile::copy(TestBinDir + nestedBin, dir + "/sub/dir/" + nestedBin));
+
+    // the files with the names of the binaries but without the binary format are not targets.
+    for (const auto &file : {"/notBinary.so", "/sub/notBinary.dll", "/sub/dir/script.sh"}) {
+        QFile notBinary(dir + file);
+        QVERIFY(notBinary.open(QIODevice::WriteOnly));
+        notBinary.write("not a binary file");
+        notBinary.close();
+    }
+
+    FileManager file;
+    DependenciesScanner scan;
+    Packing pac;
+
+    {
+        ConfigParser parser(&file, &scan, &pac);
+        QVERIFY(parser.setBinDir(dir));
+
+        auto targets = parser._config.targets().keys();
+        QVERIFY(targets == QStringList({dir + "/" + rootBin}));
+    }
+
+    {
+        ConfigParser parser(&file, &scan, &pac);
+        QVERIFY(parser.setBinDir(dir, true));
+
+        // the targets are the hash, so only the found set is checked.
+        auto targets = parser._config.targets().keys();
+        QVERIFY(targets.size() == 2);
+        QVERIFY(targets.contains(dir + "/" + rootBin));
+        QVERIFY(targets.contains(dir + "/sub/dir/" + nestedBin));
+    }
+
+    {
+        ConfigParser parser(&file, &scan, &pac);
+        QVERIFY(!parser.setBinDir(dir + "/sub"));
+        QVERIFY(parser._config.targets().isEmpty());
+    }
+
+    QDir("./binDirDiscovery").removeRecursively();
+}
+
+void deploytest::testScanerCacheTargetDir() {
+#ifdef Q_OS_UNIX
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+#else
+    QString bin = TestBinDir + "QtWidgetsProject.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+#endif
+
+    QDir("./scanerCache").removeRecursively();
+
+    auto firstTarget = QFileInfo("./scanerCache/first").absoluteFilePath();
+    auto secondTarget = QFileInfo("./scanerCache/second").absoluteFilePath();
+
+    DependenciesScanner scaner;
+
+    QuasarAppUtils::Params::parseParams({"-bin", bin, "clear", "-qmake", qmake,
+                                         "-targetDir", firstTarget});
+    {
+        Deploy deploy(&scaner);
+        QVERIFY(deploy.run() == Good);
+    }
+
+    QVERIFY(!scaner._scanedLibs.isEmpty());
+    auto key = scaner._configKey;
+
+    // the marker is removed only if the cache is dropped by the second config.
+    scaner._scanedLibs.insert("scanerCacheMarker", LibInfo());
+
+    QuasarAppUtils::Params::parseParams({"-bin", bin, "clear", "-qmake", qmake,
+                                         "-targetDir", secondTarget});
+    {
+        Deploy deploy(&scaner);
+        QVERIFY(deploy.run() == Good);
+    }
+
+    QVERIFY(scaner._configKey == key);
+    QVERIFY(scaner._scanedLibs.contains("scanerCacheMarker"));
+
+    QDir("./scanerCache").removeRecursively();
+}
+
+void deploytest::testEnvLookupCache() {
+    QDir("./envLookup").removeRecursively();
+    QVERIFY(QDir().mkpath("./envLookup/first"));
+    QVERIFY(QDir().mkpath("./envLookup/second"));
+
+    auto first = QFileInfo("./envLookup/first").absoluteFilePath();
+    auto second = QFileInfo("./envLookup/second").absoluteFilePath();
+
+    auto createFile = [](const QString& path) {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        file.write("lib");
+        file.close();
+        return true;
+    };
+
+    QVERIFY(createFile(first + "/libEnvLookup.so"));
+    QVERIFY(createFile(first + "/EnvLookup.dll"));
+
+    StatCache::clear();
+
+    DependenciesScanner scaner;
+    scaner.setEnvironment({first, second});
+
+    QVERIFY(scaner.findInEnvirement("libEnvLookup.so") == QStringList({first + "/libEnvLookup.so"}));
+#ifdef Q_OS_UNIX
+    QVERIFY(scaner.findInEnvirement("ENVLOOKUP.DLL") == QStringList({first + "/EnvLookup.dll"}));
+    QVERIFY(scaner._envDlls.contains(first));
+    QVERIFY(scaner._envDlls.contains(second));
+#endif
+
+    // the same unchanged dirs keep the found libraries.
+    scaner._envLookup.insert("envLookupMarker", {});
+    StatCache::clear();
+    scaner.setEnvironment({first, second});
+    QVERIFY(scaner._envLookup.contains("envLookupMarker"));
+
+    // the modified dir is relisted, the listing of the unchanged dir is kept.
+    QTest::qSleep(1100);
+    QVERIFY(createFile(second + "/libEnvLookup.so"));
+
+    StatCache::clear();
+    scaner.setEnvironment({first, second});
+    QVERIFY(!scaner._envLookup.contains("envLookupMarker"));
+#ifdef Q_OS_UNIX
+    QVERIFY(scaner._envDlls.contains(first));
+    QVERIFY(!scaner._envDlls.contains(second));
+#endif
+
+    QVERIFY(scaner.findInEnvirement("libEnvLookup.so") ==
+            QStringList({first + "/libEnvLookup.so", second + "/libEnvLookup.so"}));
+
+    // the dirs removed from the envirement are dropped.
+    StatCache::clear();
+    scaner.setEnvironment({second});
+    QVERIFY(!scaner._envDlls.contains(first));
+    QVERIFY(scaner.findInEnvirement("libEnvLookup.so") == QStringList({second + "/libEnvLookup.so"}));
+
+    QDir("./envLookup").removeRecursively();
+}
+
+void deploytest::testVerify() {
+#ifdef Q_OS_UNIX
+    QString bin = TestBinDir + "QtWidgetsProject";
+    QString qmake = TestQtDir + "bin/qmake";
+#else
+    QString bin = TestBinDir + "QtWidgetsProject.exe";
+    QString qmake = TestQtDir + "bin/qmake.exe";
+#endif
+
+    auto targetDir = QFileInfo("./verifyTest").absoluteFilePath();
+    QuasarAppUtils::Params::parseParams({"-bin", bin, "clear", "-qmake", qmake, "-targetDir", targetDir});
+
+    // the config of the deploy is used by the verifier, so the deploy object must be alive.
+    Deploy deploy;
+    QVERIFY(deploy.run() == Good);
+
+    Verifier verifier(deploy._scaner);
+    QVERIFY(verifier.verify());
+    QVERIFY(verifier._checked > 0);
+    QVERIFY(verifier._missing == 0);
+    QVERIFY(verifier._leaked == 0);
+
+    // find the bundled library that is required by the one binary only and is not provided by the host.
+    QHash<QString, int> dependents;
+    QHash<QString, QString> bundled;
+
+    // the tree of the utils cuts the versions of the libraries, so the real names are listed here.
+    for (const auto &file : DirWalker::paths(targetDir, DirWalker::Files)) {
+        QFileInfo info(file);
+        if (!DeployCore::isLib(info) && !DeployCore::isExecutable(info)) {
+            continue;
+        }
+
+        bundled.insert(info.fileName().toUpper(), info.absoluteFilePath());
+
+        LibInfo binary;
+        if (!deploy._scaner->fillLibInfo(binary, info.absoluteFilePath())) {
+            continue;
+        }
+
+        for (const auto &dep : binary.getDependncies()) {
+            dependents[dep.toUpper()]++;
+        }
+    }
+
+    QString removed;
+    for (auto it = dependents.cbegin(); it != dependents.cend(); ++it) {
+        if (it.value() == 1 && bundled.contains(it.key()) && !verifier._hostLibs.contains(it.key())) {
+            removed = bundled.value(it.key());
+            break;
+        }
+    }
+
+    if (removed.isEmpty()) {
+        QDir(targetDir).removeRecursively();
+        QSKIP("The distribution does not have the library required by the one binary only.");
+    }
+
+    // the removed library is reported as missing.
+    QVERIFY(QFile::remove(removed));
+
+    QVERIFY(!verifier.verify());
+    QVERIFY(verifier._missing == 1);
+    QVERIFY(verifier._leaked == 0);
+
+    QDir(targetDir).removeRecursively();
+}
+
+void deploytest::testDebugDir() {
+#ifdef Q_OS_UNIX
+    if (QStandardPaths::findExecutable("strip").isEmpty() ||
+            QStandardPaths::findExecutable("objcopy").isEmpty()) {
+        QSKIP("The strip and the objcopy tools are not found.");
+    }
+
+    auto libs = QDir(TestQtDir + "lib").entryInfoList({"libQt5Core.so*"}, QDir::Files);
+    if (libs.isEmpty()) {
+        QSKIP("The Qt of the tests does not have the libQt5Core library.");
+    }
+
+    QDir("./debugDirTest").removeRecursively();
+    QVERIFY(QDir().mkpath("./debugDirTest/lib"));
+
+    auto lib = QFileInfo("./debugDirTest/lib/libQt5Core.so.5").absoluteFilePath();
+    auto debugDir = QFileInfo("./debugDirTest/debug").absoluteFilePath();
+    QVERIFY(QFile::copy(libs.first().absoluteFilePath(), lib));
+    QVERIFY(QFile::setPermissions(lib, QFile::permissions(lib) | QFile::WriteOwner));
+
+    auto buildId = ELF().getBuildId(lib);
+    if (buildId.size() <= 2) {
+        QDir("./debugDirTest").removeRecursively();
+        QSKIP("The libQt5Core library does not have the build id.");
+    }
+
+    QuasarAppUtils::Params::parseParams({"-debugDir", debugDir});
+
+    FileManager file;
+    QVERIFY(file.strip(QFileInfo(lib).absolutePath()));
+
+    // the debug info is saved into the build-id indexed tree.
+    auto debugName = buildId.mid(2) + ".debug";
+    auto debugFile = debugDir + "/.build-id/" + buildId.left(2) + "/" + debugName;
+    QVERIFY(QFileInfo(debugFile).isFile());
+    QVERIFY(QFileInfo(debugFile).size() > 0);
+
+    // the stripped library keeps the build id and links to the debug file by the name.
+    QVERIFY(ELF().getBuildId(lib) == buildId);
+
+    QFile stripped(lib);
+    QVERIFY(stripped.open(QIODevice::ReadOnly));
+    auto data = stripped.readAll();
+    stripped.close();
+
+    QVERIFY(data.contains(".gnu_debuglink"));
+    QVERIFY(data.contains(debugName));
+
+    // the saved debug info is not extracted again from the stripped library.
+    auto modified = QFileInfo(debugFile).lastModified();
+    StatCache::clear();
+    QVERIFY(file.strip(lib));
+    QVERIFY(QFileInfo(debugFile).lastModified() == modified);
+
+    QDir("./debugDirTest").removeRecursively();
+#endif
+}
+
+void deploytest::testFindProcess() {
+#ifdef Q_OS_UNIX
+    QDir("./findProcess").removeRecursively();
+    QVERIFY(QDir().mkpath("./findProcess/first"));
+    QVERIFY(QDir().mkpath("./findProcess/second"));
+    QVERIFY(QDir().mkpath("./findProcess/third/qmake"));
+
+    auto first = QFileInfo("./findProcess/first").absoluteFilePath();
+    auto second = QFileInfo("./findProcess/second").absoluteFilePath();
+    auto third = QFileInfo("./findProcess/third").absoluteFilePath();
+
+    auto createQmake = [](const QString& path, bool executable) {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        file.write("#!/bin/sh\n");
+        file.close();
+
+        auto permissions = QFile::ReadOwner | QFile::WriteOwner;
+        if (executable) {
+            permissions |= QFile::ExeOwner;
+        }
+
+        return file.setPermissions(permissions);
+    };
+
+    // the not executable file and the dir with the name of the process are skipped.
+    QVERIFY(createQmake(first + "/qmake", false));
+    QVERIFY(createQmake(second + "/qmake", true));
+
+    auto env = QStringList{third, first, second}.join(DeployCore::getEnvSeparator());
+
+    DeployCore::clearProcessCache();
+    StatCache::clear();
+
+    QVERIFY(DeployCore::findProcess(env, "qmake") == second + "/qmake");
+    QVERIFY(DeployCore::findProcess(env, "notExistsProcess").isEmpty());
+
+    // the found executable is remembered until the cache is cleared.
+    QVERIFY(QFile::setPermissions(first + "/qmake", QFile::permissions(first + "/qmake") | QFile::ExeOwner));
+    QVERIFY(DeployCore::findProcess(env, "qmake") == second + "/qmake");
+
+    DeployCore::clearProcessCache();
+    QVERIFY(DeployCore::findProcess(env, "qmake") == first + "/qmake");
+
+    // the remembered executable is checked again before use.
+    QVERIFY(QFile::setPermissions(first + "/qmake", QFile::ReadOwner | QFile::WriteOwner));
+    QVERIFY(DeployCore::findProcess(env, "qmake") == second + "/qmake");
+
+    QDir("./findProcess").removeRecursively();
+#endif
+}
+
 QTEST_APPLESS_MAIN(deploytest)
 
 #include "tst_deploytest.moc"